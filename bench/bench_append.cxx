@@ -0,0 +1,68 @@
+/** Per-record vs. buffered appending along an unlimited dimension.
+ *
+ * Appends records one at a time using hyperslab writes and using a
+ * RecordAppender and reports the median throughput over several runs.
+ */
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+namespace {
+
+netcdf4::File create_file(std::string name, size_t nx, size_t ny) {
+  auto file = netcdf4::File::create(name);
+  auto tx = file.define();
+  tx.add_dimension("time");
+  tx.add_dimension("x", static_cast<int>(nx));
+  tx.add_dimension("y", static_cast<int>(ny));
+  netcdf4::StorageOptions storage{};
+  storage.layout = netcdf4::Layout::Chunked;
+  storage.chunk_sizes = {16, nx, ny};
+  tx.add_variable("field", {"time", "x", "y"}, netcdf4::Type::Float, storage);
+  tx.commit();
+  return file;
+}
+
+}  // namespace
+
+int main() {
+  size_t n_records = 512;
+  size_t n_repetitions = 7;
+  std::string name = "bench_append.nc";
+
+  for (size_t n : {16, 128}) {
+    std::vector<float> record(n * n, 1.0f);
+    double megabytes = n_records * record.size() * sizeof(float) / 1e6;
+    std::cout << n << " x " << n << " records:" << std::endl;
+
+    double ms = 1e-6 * bench::measure(1, n_repetitions, [&]() {
+      auto file = create_file(name, n, n);
+      auto var = file.get_variable("field");
+      for (size_t i = 0; i < n_records; ++i) {
+        var.write(std::array<size_t, 3>{i, 0, 0},
+                  std::array<size_t, 3>{1, n, n},
+                  record.data());
+      }
+      file.close();
+    }).median;
+    std::cout << "  per-record writes:   " << ms << " ms, "
+              << megabytes / ms * 1e3 << " MB/s" << std::endl;
+
+    for (size_t capacity : {16, 128}) {
+      ms = 1e-6 * bench::measure(1, n_repetitions, [&]() {
+        auto file = create_file(name, n, n);
+        netcdf4::RecordAppender<float> appender(file.get_variable("field"),
+                                                capacity);
+        for (size_t i = 0; i < n_records; ++i) {
+          appender.append(record.data());
+        }
+        appender.flush();
+        file.close();
+      }).median;
+      std::cout << "  appender (" << capacity << " records): " << ms << " ms, "
+                << megabytes / ms * 1e3 << " MB/s" << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,182 @@
+/** Helpers shared by the netcdfhpp benchmarks.
+ *
+ * Provides a minimal timing harness that measures the average
+ * wall-clock time per call of a piece of code, and a result table
+ * that can be written in machine-readable formats.
+ */
+#ifndef __NETCDF_BENCH_COMMON_HPP__
+#define __NETCDF_BENCH_COMMON_HPP__
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+/** Time code snippet.
+ *
+ * Calls the given function n_calls times, after a short warm up,
+ * and returns the average time per call.
+ *
+ * @param n_calls The number of times to call the function.
+ * @param f The function to benchmark.
+ * @return The average time per call in nanoseconds.
+ */
+template <typename F>
+double time_per_call(size_t n_calls, F&& f) {
+  size_t n_warmup = n_calls / 10 + 1;
+  for (size_t i = 0; i < n_warmup; ++i) {
+    f();
+  }
+  auto start = Clock::now();
+  for (size_t i = 0; i < n_calls; ++i) {
+    f();
+  }
+  auto stop = Clock::now();
+  std::chrono::duration<double, std::nano> elapsed = stop - start;
+  return elapsed.count() / static_cast<double>(n_calls);
+}
+
+/** Time single execution of code snippet.
+ *
+ * @param f The function to benchmark.
+ * @return The wall-clock time of the call in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f) {
+  auto start = Clock::now();
+  f();
+  auto stop = Clock::now();
+  std::chrono::duration<double, std::milli> elapsed = stop - start;
+  return elapsed.count();
+}
+
+/** Print benchmark result.
+ *
+ * @param name The name of the benchmark.
+ * @param ns_per_call The measured time per call in nanoseconds.
+ */
+inline void report(std::string name, double ns_per_call) {
+  std::cout << std::left << std::setw(48) << name << std::right
+            << std::setw(14) << std::fixed << std::setprecision(1)
+            << ns_per_call << " ns/call" << std::endl;
+}
+
+/// Statistics of repeated measurements.
+struct Timing {
+  /// Median time per call in nanoseconds.
+  double median = 0.0;
+  /// Minimum time per call in nanoseconds.
+  double min = 0.0;
+  /// Maximum time per call in nanoseconds.
+  double max = 0.0;
+};
+
+/** Time code snippet repeatedly.
+ *
+ * Measures the average time per call n_repetitions times and returns
+ * statistics over the repetitions.
+ *
+ * @param n_calls The number of calls per repetition.
+ * @param n_repetitions The number of repetitions.
+ * @param f The function to benchmark.
+ * @return Timing statistics in nanoseconds per call.
+ */
+template <typename F>
+Timing measure(size_t n_calls, size_t n_repetitions, F&& f) {
+  std::vector<double> times;
+  times.reserve(n_repetitions);
+  for (size_t i = 0; i < n_repetitions; ++i) {
+    times.push_back(time_per_call(n_calls, f));
+  }
+  std::sort(times.begin(), times.end());
+  return {times[times.size() / 2], times.front(), times.back()};
+}
+
+/// Result of a single benchmark case.
+struct Result {
+  /// Group of related cases, e.g. the API call that is benchmarked.
+  std::string group;
+  /// Name of the case within the group.
+  std::string name;
+  /// The implementation, either "netcdfhpp" or "netcdf-c".
+  std::string variant;
+  /// The number of calls per repetition.
+  size_t n_calls;
+  /// Measured time per call.
+  Timing timing;
+};
+
+/** Collection of benchmark results.
+ *
+ * Results are printed as a table when they are added and can be
+ * written to JSON or CSV files to track performance over releases.
+ */
+class Results {
+ public:
+  /// Add result and print it.
+  void add(Result result) {
+    report(result.group + "/" + result.name + " [" + result.variant + "]",
+           result.timing.median);
+    results_.push_back(result);
+  }
+
+  /** Write results as CSV.
+   *
+   * @param path The file to write the results to.
+   */
+  void write_csv(std::string path) const {
+    std::ofstream out(path);
+    out << "group,name,variant,n_calls,median_ns,min_ns,max_ns\n";
+    for (auto& r : results_) {
+      out << r.group << "," << r.name << "," << r.variant << "," << r.n_calls
+          << "," << r.timing.median << "," << r.timing.min << ","
+          << r.timing.max << "\n";
+    }
+  }
+
+  /** Write results as JSON.
+   *
+   * @param path The file to write the results to.
+   * @param library_version Version string of the NetCDF-c library.
+   */
+  void write_json(std::string path, std::string library_version) const {
+    std::ofstream out(path);
+    out << "{\n  \"library_version\": \"" << escape(library_version) << "\",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results_.size(); ++i) {
+      auto& r = results_[i];
+      out << "    {\"group\": \"" << escape(r.group) << "\", \"name\": \""
+          << escape(r.name) << "\", \"variant\": \"" << escape(r.variant)
+          << "\", \"n_calls\": " << r.n_calls
+          << ", \"median_ns\": " << r.timing.median
+          << ", \"min_ns\": " << r.timing.min
+          << ", \"max_ns\": " << r.timing.max << "}"
+          << (i + 1 < results_.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+  }
+
+ private:
+  static std::string escape(const std::string& s) {
+    std::string result;
+    for (char c : s) {
+      if (c == '"' || c == '\\') {
+        result += '\\';
+      }
+      result += c;
+    }
+    return result;
+  }
+
+  std::vector<Result> results_;
+};
+
+}  // namespace bench
+#endif
@@ -0,0 +1,53 @@
+/** Cost of type conversion on read.
+ *
+ * Compares reading a variable into a buffer of a different type using
+ * in-memory conversion, conversion by the NetCDF-c library and a native
+ * read followed by a copy loop, for common pairs of types.
+ */
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+template <typename Source, typename Destination>
+void bench_conversion(netcdf4::File& file, std::string name, netcdf4::Type type) {
+  size_t n = 2000 * 2000;
+  auto var = file.add_variable(name, {"x", "y"}, type);
+  std::vector<Source> data(n);
+  for (size_t i = 0; i < n; ++i) {
+    data[i] = static_cast<Source>(i % 1000);
+  }
+  var.write(data.data());
+
+  std::vector<Destination> output(n);
+  size_t n_calls = 10;
+  std::cout << name << ":" << std::endl;
+  bench::report("  read_as (native conversion)", bench::time_per_call(n_calls, [&]() {
+    var.read_as(output.data(), netcdf4::Conversion::Native);
+  }));
+  bench::report("  read_as (library conversion)", bench::time_per_call(n_calls, [&]() {
+    var.read_as(output.data(), netcdf4::Conversion::Library);
+  }));
+  bench::report("  read + copy loop", bench::time_per_call(n_calls, [&]() {
+    std::vector<Source> buffer(n);
+    var.read(buffer.data());
+    for (size_t i = 0; i < n; ++i) {
+      output[i] = static_cast<Destination>(buffer[i]);
+    }
+  }));
+  bench::report("  read (no conversion)", bench::time_per_call(n_calls, [&]() {
+    var.read(data.data());
+  }));
+}
+
+int main() {
+  auto file = netcdf4::File::create("bench_conversion.nc");
+  file.add_dimension("x", 2000);
+  file.add_dimension("y", 2000);
+  bench_conversion<short, float>(file, "short_to_float", netcdf4::Type::Short);
+  bench_conversion<float, double>(file, "float_to_double", netcdf4::Type::Float);
+  bench_conversion<long long, double>(file, "int64_to_double", netcdf4::Type::Int64);
+  bench_conversion<double, float>(file, "double_to_float", netcdf4::Type::Double);
+  file.close();
+  return 0;
+}
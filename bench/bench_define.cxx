@@ -0,0 +1,39 @@
+/** Schema creation time.
+ *
+ * Compares the time required to create files with a growing number of
+ * variables using the Group::add_* methods, which synchronize the file
+ * after every definition, and a single define transaction.
+ */
+#include <string>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+int main() {
+  std::cout << std::setw(10) << "variables" << std::setw(20) << "add_variable [ms]"
+            << std::setw(20) << "transaction [ms]" << std::endl;
+  for (size_t n_vars : {10, 100, 1000, 10000}) {
+    double t_single = bench::time_ms([n_vars]() {
+      auto file = netcdf4::File::create("bench_define_single.nc");
+      file.add_dimension("x", 100);
+      for (size_t i = 0; i < n_vars; ++i) {
+        file.add_variable("var_" + std::to_string(i), {"x"}, netcdf4::Type::Float);
+      }
+      file.close();
+    });
+    double t_transaction = bench::time_ms([n_vars]() {
+      auto file = netcdf4::File::create("bench_define_transaction.nc");
+      auto tx = file.define();
+      tx.add_dimension("x", 100);
+      for (size_t i = 0; i < n_vars; ++i) {
+        tx.add_variable("var_" + std::to_string(i), {"x"}, netcdf4::Type::Float);
+      }
+      tx.commit();
+      file.close();
+    });
+    std::cout << std::setw(10) << n_vars << std::setw(20) << std::fixed
+              << std::setprecision(1) << t_single << std::setw(20)
+              << t_transaction << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,40 @@
+/** Write throughput with and without prefilling.
+ *
+ * Creates files with a single large variable and writes the complete
+ * variable using Variable::write(T*) with the file in fill and no-fill
+ * mode.
+ */
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+int main() {
+  std::string name = "bench_fill.nc";
+  size_t n_repetitions = 5;
+
+  for (size_t n : {256, 2048}) {
+    std::vector<float> data(n * n, 1.0f);
+    double megabytes = data.size() * sizeof(float) / 1e6;
+    std::cout << n << " x " << n << " floats:" << std::endl;
+
+    for (auto layout : {netcdf4::Layout::Contiguous, netcdf4::Layout::Chunked}) {
+      for (auto fill_mode : {netcdf4::FillMode::Fill, netcdf4::FillMode::NoFill}) {
+        double ms = 1e-6 * bench::measure(1, n_repetitions, [&]() {
+          auto file = netcdf4::File::create(name, netcdf4::CreationMode::Clobber, fill_mode);
+          file.add_dimension("x", n);
+          file.add_dimension("y", n);
+          netcdf4::StorageOptions storage{};
+          storage.layout = layout;
+          auto var = file.add_variable("field", {"x", "y"}, netcdf4::Type::Float, storage);
+          var.write(data.data());
+          file.close();
+        }).median;
+        std::cout << "  " << (layout == netcdf4::Layout::Contiguous ? "contiguous" : "chunked   ")
+                  << (fill_mode == netcdf4::FillMode::Fill ? " fill:    " : " no fill: ")
+                  << ms << " ms, " << megabytes / ms * 1e3 << " MB/s" << std::endl;
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,50 @@
+/** Reading versus mapping a large contiguous variable.
+ *
+ * Times reading the complete variable into a buffer and mapping it with
+ * Variable::map followed by a pass over the data. Without HDF5 support
+ * map falls back to reading.
+ */
+#include <numeric>
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+int main() {
+  std::string name = "bench_map.nc";
+  size_t size = 2048;
+  {
+    netcdf4::File::set_default_alignment(0, 4096);
+    auto file = netcdf4::File::create(name);
+    netcdf4::File::set_default_alignment(0, 1);
+    file.add_dimension("x", size);
+    file.add_dimension("y", size);
+    netcdf4::StorageOptions storage{};
+    storage.layout = netcdf4::Layout::Contiguous;
+    auto var = file.add_variable("field", {"x", "y"}, netcdf4::Type::Float, storage);
+    std::vector<float> data(size * size);
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = static_cast<float>(i % 1000);
+    }
+    var.write(data.data());
+    file.close();
+  }
+
+  auto file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+  auto var = file.get_variable("field");
+  std::cout << "Mapped: " << var.map<float>().is_mapped() << std::endl;
+
+  size_t n_calls = 20;
+  double sum = 0.0;
+  bench::report("read", bench::time_per_call(n_calls, [&]() {
+    std::vector<float> data(size * size);
+    var.read(data.data());
+    sum += std::accumulate(data.begin(), data.end(), 0.0);
+  }));
+  bench::report("map", bench::time_per_call(n_calls, [&]() {
+    auto view = var.map<float>();
+    sum += std::accumulate(view.begin(), view.end(), 0.0);
+  }));
+  std::cout << "Checksum: " << sum << std::endl;
+  return 0;
+}
@@ -0,0 +1,85 @@
+/** Per-call overhead of define/data mode handling.
+ *
+ * Compares the cost of scalar and small hyperslab accesses through
+ * the Variable interface against the raw NetCDF-c calls, with and
+ * without the nc_enddef call that previously preceded every data
+ * access.
+ */
+#include <array>
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+int main() {
+  size_t n_calls = 100000;
+
+  auto file = netcdf4::File::create("bench_mode_switch.nc");
+  file.add_dimension("x", 100);
+  file.add_dimension("y", 100);
+  auto scalar = file.add_variable("scalar", {}, netcdf4::Type::Int);
+  auto field = file.add_variable("field", {"x", "y"}, netcdf4::Type::Float);
+  scalar.write(42);
+  std::vector<float> data(100 * 100, 1.0f);
+  field.write(data.data());
+
+  int nc_id = file.get_id();
+  int scalar_id = scalar.get_id();
+  int field_id = field.get_id();
+  std::array<size_t, 2> starts = {10, 10};
+  std::array<size_t, 2> counts = {4, 4};
+  std::array<float, 16> slab;
+  int value = 0;
+
+  std::cout << "Scalar reads:" << std::endl;
+  bench::report("  nc_enddef + nc_get_var1_int (previous)",
+                bench::time_per_call(n_calls, [&]() {
+                  nc_enddef(nc_id);
+                  nc_get_var1_int(nc_id, scalar_id, 0, &value);
+                }));
+  bench::report("  Variable::read<int>()",
+                bench::time_per_call(n_calls, [&]() {
+                  value = scalar.read<int>();
+                }));
+  bench::report("  nc_get_var1_int",
+                bench::time_per_call(n_calls, [&]() {
+                  nc_get_var1_int(nc_id, scalar_id, 0, &value);
+                }));
+
+  std::cout << "Hyperslab (4 x 4) reads:" << std::endl;
+  bench::report("  nc_enddef + nc_get_vara_float (previous)",
+                bench::time_per_call(n_calls, [&]() {
+                  nc_enddef(nc_id);
+                  nc_get_vara_float(nc_id, field_id, starts.data(),
+                                    counts.data(), slab.data());
+                }));
+  bench::report("  Variable::read(starts, counts, data)",
+                bench::time_per_call(n_calls, [&]() {
+                  field.read(starts, counts, slab.data());
+                }));
+  bench::report("  nc_get_vara_float",
+                bench::time_per_call(n_calls, [&]() {
+                  nc_get_vara_float(nc_id, field_id, starts.data(),
+                                    counts.data(), slab.data());
+                }));
+
+  std::cout << "Hyperslab (4 x 4) writes:" << std::endl;
+  bench::report("  nc_enddef + nc_put_vara_float (previous)",
+                bench::time_per_call(n_calls, [&]() {
+                  nc_enddef(nc_id);
+                  nc_put_vara_float(nc_id, field_id, starts.data(),
+                                    counts.data(), slab.data());
+                }));
+  bench::report("  Variable::write(starts, counts, data)",
+                bench::time_per_call(n_calls, [&]() {
+                  field.write(starts, counts, slab.data());
+                }));
+  bench::report("  nc_put_vara_float",
+                bench::time_per_call(n_calls, [&]() {
+                  nc_put_vara_float(nc_id, field_id, starts.data(),
+                                    counts.data(), slab.data());
+                }));
+
+  file.close();
+  return value == 42 ? 0 : 1;
+}
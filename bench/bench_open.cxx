@@ -0,0 +1,72 @@
+/** Open latency for deep group hierarchies.
+ *
+ * Creates synthetic files with nested groups containing many variables
+ * and measures the time required to open them and extract a single
+ * variable from the deepest group, with lazy and eager parsing.
+ */
+#include <string>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+// Recursively define groups of the given depth and fan-out, each
+// containing n_vars variables.
+void define_groups(netcdf4::DefineTransaction& tx,
+                   size_t depth,
+                   size_t fan_out,
+                   size_t n_vars) {
+  for (size_t i = 0; i < n_vars; ++i) {
+    tx.add_variable("var_" + std::to_string(i), {"x", "y"}, netcdf4::Type::Float);
+  }
+  if (depth == 0) {
+    return;
+  }
+  for (size_t i = 0; i < fan_out; ++i) {
+    define_groups(tx.add_group("group_" + std::to_string(i)), depth - 1, fan_out, n_vars);
+  }
+}
+
+int main() {
+  size_t n_repetitions = 10;
+  size_t fan_out = 3;
+  size_t n_vars = 20;
+
+  std::cout << std::setw(8) << "depth" << std::setw(16) << "lazy [ms]"
+            << std::setw(16) << "eager [ms]" << std::endl;
+  for (size_t depth : {1, 2, 3, 4}) {
+    std::string name = "bench_open_" + std::to_string(depth) + ".nc";
+    {
+      auto file = netcdf4::File::create(name);
+      auto tx = file.define();
+      tx.add_dimension("x", 10);
+      tx.add_dimension("y", 10);
+      define_groups(tx, depth, fan_out, n_vars);
+      tx.commit();
+      file.close();
+    }
+
+    auto open_and_extract = [&](netcdf4::ParseMode parse_mode) {
+      float sum = 0.0;
+      auto file = netcdf4::File::open(name, netcdf4::OpenMode::Write, parse_mode);
+      netcdf4::Group group = file;
+      for (size_t i = 0; i < depth; ++i) {
+        group = group.get_group("group_0");
+      }
+      auto var = group.get_variable("var_0");
+      std::array<size_t, 2> starts = {0, 0};
+      std::array<size_t, 2> counts = {1, 1};
+      var.read(starts, counts, &sum);
+      file.close();
+    };
+
+    double t_lazy = 0.0, t_eager = 0.0;
+    for (size_t i = 0; i < n_repetitions; ++i) {
+      t_lazy += bench::time_ms([&]() { open_and_extract(netcdf4::ParseMode::Lazy); });
+      t_eager += bench::time_ms([&]() { open_and_extract(netcdf4::ParseMode::Eager); });
+    }
+    std::cout << std::setw(8) << depth << std::setw(16) << std::fixed
+              << std::setprecision(2) << t_lazy / n_repetitions << std::setw(16)
+              << t_eager / n_repetitions << std::endl;
+  }
+  return 0;
+}
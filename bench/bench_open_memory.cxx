@@ -0,0 +1,82 @@
+/** Random hyperslab reads from files opened from disk and from memory.
+ *
+ * Opens the same file from its path, from a copy of its contents, from
+ * its contents without copying and from a shared memory mapping, and
+ * times opening followed by random hyperslab reads.
+ */
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+namespace {
+
+void read_hyperslabs(netcdf4::File& file, size_t n_reads, size_t n, size_t size) {
+  auto var = file.get_variable("field");
+  std::vector<float> slab(n * n);
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<size_t> offset(0, size - n);
+  for (size_t i = 0; i < n_reads; ++i) {
+    var.read(std::array<size_t, 2>{offset(generator), offset(generator)},
+             std::array<size_t, 2>{n, n},
+             slab.data());
+  }
+}
+
+}  // namespace
+
+int main() {
+  std::string name = "bench_open_memory.nc";
+  size_t size = 1024;
+  {
+    auto file = netcdf4::File::create(name);
+    file.add_dimension("x", size);
+    file.add_dimension("y", size);
+    netcdf4::StorageOptions storage{};
+    storage.chunk_sizes = {64, 64};
+    auto var = file.add_variable("field", {"x", "y"}, netcdf4::Type::Float, storage);
+    std::vector<float> data(size * size);
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = static_cast<float>(i % 1000);
+    }
+    var.write(data.data());
+    file.close();
+  }
+
+  std::vector<std::byte> bytes;
+  {
+    std::ifstream in(name, std::ios::binary | std::ios::ate);
+    bytes.resize(in.tellg());
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+  }
+  auto mapping = netcdf4::MappedFile::map(name);
+
+  size_t n_calls = 20;
+  for (size_t n_reads : {0, 100, 1000}) {
+    std::cout << "Open + " << n_reads << " random 32 x 32 reads:" << std::endl;
+    bench::report("  path", bench::time_per_call(n_calls, [&]() {
+      auto file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+      read_hyperslabs(file, n_reads, 32, size);
+    }));
+    bench::report("  memory (copy)", bench::time_per_call(n_calls, [&]() {
+      auto file = netcdf4::File::open_memory(bytes);
+      read_hyperslabs(file, n_reads, 32, size);
+    }));
+    bench::report("  memory (zero-copy)", bench::time_per_call(n_calls, [&]() {
+      auto file = netcdf4::File::open_memory(bytes, netcdf4::BufferMode::ZeroCopy);
+      read_hyperslabs(file, n_reads, 32, size);
+    }));
+    bench::report("  shared mapping", bench::time_per_call(n_calls, [&]() {
+      auto file = netcdf4::File::open_memory(mapping);
+      read_hyperslabs(file, n_reads, 32, size);
+    }));
+    bench::report("  open_mapped", bench::time_per_call(n_calls, [&]() {
+      auto file = netcdf4::File::open_mapped(name);
+      read_hyperslabs(file, n_reads, 32, size);
+    }));
+  }
+  return 0;
+}
@@ -0,0 +1,48 @@
+/** Hyperslab reads in read-only and write mode.
+ *
+ * Measures tight loops of small hyperslab reads from files opened in
+ * read-only mode and in write mode.
+ */
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+int main() {
+  size_t n_calls = 100000;
+  std::string name = "bench_read_only.nc";
+  {
+    auto file = netcdf4::File::create(name);
+    file.add_dimension("time");
+    file.add_dimension("x", 256);
+    file.add_dimension("y", 256);
+    auto var = file.add_variable("field", {"time", "x", "y"}, netcdf4::Type::Float);
+    std::vector<float> data(16 * 256 * 256, 1.0f);
+    var.write(std::array<size_t, 3>{0, 0, 0}, std::array<size_t, 3>{16, 256, 256}, data.data());
+    file.close();
+  }
+
+  for (auto mode : {netcdf4::OpenMode::Write, netcdf4::OpenMode::ReadOnly}) {
+    auto file = netcdf4::File::open(name, mode);
+    auto var = file.get_variable("field");
+    std::cout << (mode == netcdf4::OpenMode::ReadOnly ? "Read-only mode:" : "Write mode:")
+              << std::endl;
+    for (size_t n : {1, 8, 64}) {
+      std::vector<float> slab(n * n);
+      size_t i = 0;
+      bench::report("  " + std::to_string(n) + " x " + std::to_string(n) + " hyperslab",
+                    bench::time_per_call(n_calls, [&]() {
+                      std::array<size_t, 3> starts = {i % 16, (i * 7) % (256 - n), (i * 13) % (256 - n)};
+                      std::array<size_t, 3> counts = {1, n, n};
+                      var.read(starts, counts, slab.data());
+                      ++i;
+                    }));
+    }
+    bench::report("  scalar read<float>()", bench::time_per_call(n_calls, [&]() {
+      volatile float value = var.read<float>();
+      (void) value;
+    }));
+    file.close();
+  }
+  return 0;
+}
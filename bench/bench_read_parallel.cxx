@@ -0,0 +1,61 @@
+/** Serial vs. parallel decompression of compressed variables.
+ *
+ * Reads a deflate-compressed variable completely, once using a regular
+ * read and once using Variable::read_parallel with different numbers of
+ * threads, for several chunk sizes. The file is reopened for every read
+ * so that chunks aren't served from the chunk cache. Reports the median
+ * throughput.
+ */
+#include <cmath>
+#include <iomanip>
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+int main() {
+  std::string name = "bench_read_parallel.nc";
+  size_t n = 2048;
+  size_t n_repetitions = 5;
+  std::vector<float> data(n * n);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = std::round(100.0f * std::sin(1e-4f * static_cast<float>(i)));
+  }
+  double megabytes = data.size() * sizeof(float) / 1e6;
+
+  for (size_t chunk_size : {64, 256, 1024}) {
+    {
+      auto file = netcdf4::File::create(name);
+      file.add_dimension("x", n);
+      file.add_dimension("y", n);
+      netcdf4::StorageOptions storage{};
+      storage.chunk_sizes = {chunk_size, chunk_size};
+      storage.deflate_level = 4;
+      storage.shuffle = true;
+      auto var = file.add_variable("field", {"x", "y"}, netcdf4::Type::Float, storage);
+      var.write(data.data());
+      file.close();
+    }
+    std::vector<float> result(data.size());
+    std::cout << chunk_size << " x " << chunk_size << " chunks:" << std::endl;
+
+    double ms = 1e-6 * bench::measure(1, n_repetitions, [&]() {
+      auto file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+      file.get_variable("field").read(result.data());
+    }).median;
+    std::cout << "  read:                  " << ms << " ms, "
+              << megabytes / ms * 1e3 << " MB/s" << std::endl;
+
+    for (size_t n_threads : {1, 2, 4, 8, 16, 32}) {
+      bool parallel = false;
+      ms = 1e-6 * bench::measure(1, n_repetitions, [&]() {
+        auto file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+        parallel = file.get_variable("field").read_parallel(result.data(), n_threads);
+      }).median;
+      std::cout << "  read_parallel (" << std::setw(2) << n_threads << "): " << ms
+                << " ms, " << megabytes / ms * 1e3 << " MB/s"
+                << (parallel ? "" : " (fallback)") << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,77 @@
+/** Synchronous vs. read-ahead scans over the records of a variable.
+ *
+ * Scans all records of a deflate-compressed variable and processes
+ * each record, either reading records one at a time or using a
+ * RecordReader that prefetches the following records while the
+ * current one is processed. Reports the median wall-clock time.
+ */
+#include <cmath>
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+namespace {
+
+constexpr size_t n_records = 128;
+constexpr size_t n = 256;
+
+// Stand-in for the processing of a record.
+double process(std::span<const float> record) {
+  double result = 0.0;
+  for (auto value : record) {
+    result += std::sqrt(std::abs(std::sin(value)));
+  }
+  return result;
+}
+
+}  // namespace
+
+int main() {
+  std::string name = "bench_record_reader.nc";
+  {
+    auto file = netcdf4::File::create(name);
+    file.add_dimension("time");
+    file.add_dimension("x", n);
+    file.add_dimension("y", n);
+    netcdf4::StorageOptions storage{};
+    storage.chunk_sizes = {1, n, n};
+    storage.deflate_level = 4;
+    storage.shuffle = true;
+    auto var = file.add_variable("field", {"time", "x", "y"}, netcdf4::Type::Float, storage);
+    std::vector<float> record(n * n);
+    for (size_t i = 0; i < n_records; ++i) {
+      for (size_t j = 0; j < record.size(); ++j) {
+        record[j] = static_cast<float>((i * j) % 1024) * 0.1f;
+      }
+      var.write(std::array<size_t, 3>{i, 0, 0}, std::array<size_t, 3>{1, n, n}, record.data());
+    }
+    file.close();
+  }
+
+  auto file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+  auto var = file.get_variable("field");
+  size_t n_repetitions = 5;
+  double checksum = 0.0;
+
+  double ms = 1e-6 * bench::measure(1, n_repetitions, [&]() {
+    std::vector<float> record(n * n);
+    for (size_t i = 0; i < n_records; ++i) {
+      var.read(std::array<size_t, 3>{i, 0, 0}, std::array<size_t, 3>{1, n, n}, record.data());
+      checksum += process(record);
+    }
+  }).median;
+  std::cout << "synchronous reads:      " << ms << " ms" << std::endl;
+
+  for (size_t n_prefetch : {1, 2, 4}) {
+    ms = 1e-6 * bench::measure(1, n_repetitions, [&]() {
+      netcdf4::RecordReader<float> reader(var, n_prefetch);
+      for (auto record : reader) {
+        checksum += process(record);
+      }
+    }).median;
+    std::cout << "read-ahead (" << n_prefetch << " records): " << ms << " ms" << std::endl;
+  }
+  std::cout << "Checksum: " << checksum << std::endl;
+  return 0;
+}
@@ -0,0 +1,224 @@
+/** Benchmark suite for the netcdfhpp interface.
+ *
+ * Times the main operations of the File, Group and Variable classes
+ * on synthetic files and compares each against the equivalent sequence
+ * of raw NetCDF-c calls.
+ *
+ * Usage: bench_suite [--json <file>] [--csv <file>] [--quick]
+ */
+#include <string>
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+using bench::Result;
+
+namespace {
+
+size_t n_repetitions = 5;
+
+// Scale number of calls down in quick mode.
+size_t scale = 1;
+
+size_t calls(size_t n) { return std::max<size_t>(n / scale, 1); }
+
+void check(int error) { netcdf4::detail::handle_error("Benchmark error:", error); }
+
+// Creates the file used by the data access benchmarks.
+void create_data_file(std::string path, size_t nx, size_t ny) {
+  auto file = netcdf4::File::create(path);
+  auto tx = file.define();
+  tx.add_dimension("x", static_cast<int>(nx));
+  tx.add_dimension("y", static_cast<int>(ny));
+  tx.add_variable("field", {"x", "y"}, netcdf4::Type::Float);
+  tx.add_variable("scalar", {}, netcdf4::Type::Int);
+  tx.commit();
+  std::vector<float> data(nx * ny, 1.0f);
+  file.get_variable("field").write(data.data());
+  file.get_variable("scalar").write(1);
+  file.close();
+}
+
+void bench_files(bench::Results& results) {
+  std::string path = "bench_suite_file.nc";
+  size_t n = calls(100);
+  results.add({"file", "create", "netcdfhpp", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 auto file = netcdf4::File::create(path);
+                 file.close();
+               })});
+  results.add({"file", "create", "netcdf-c", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 int id = 0;
+                 check(nc_create(path.c_str(), NC_CLOBBER | NC_NETCDF4, &id));
+                 check(nc_close(id));
+               })});
+
+  create_data_file(path, 100, 100);
+  results.add({"file", "open", "netcdfhpp", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 auto file = netcdf4::File::open(path, netcdf4::OpenMode::ReadOnly);
+                 file.close();
+               })});
+  results.add({"file", "open", "netcdf-c", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 int id = 0;
+                 check(nc_open(path.c_str(), NC_NOWRITE, &id));
+                 check(nc_close(id));
+               })});
+  results.add({"file", "open_get_variable", "netcdfhpp", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 auto file = netcdf4::File::open(path, netcdf4::OpenMode::ReadOnly);
+                 auto var = file.get_variable("field");
+                 file.close();
+               })});
+  results.add({"file", "open_get_variable", "netcdf-c", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 int id = 0, var_id = 0, n_dims = 0, type = 0;
+                 int dim_ids[NC_MAX_VAR_DIMS];
+                 char name[NC_MAX_NAME + 1];
+                 check(nc_open(path.c_str(), NC_NOWRITE, &id));
+                 check(nc_inq_varid(id, "field", &var_id));
+                 check(nc_inq_var(id, var_id, name, &type, &n_dims, dim_ids, 0));
+                 check(nc_close(id));
+               })});
+}
+
+void bench_definitions(bench::Results& results) {
+  std::string path = "bench_suite_define.nc";
+  size_t n_vars = 100;
+  size_t n = calls(10);
+  results.add({"define", "add_variable_x100", "netcdfhpp", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 auto file = netcdf4::File::create(path);
+                 file.add_dimension("x", 100);
+                 for (size_t i = 0; i < n_vars; ++i) {
+                   file.add_variable("var_" + std::to_string(i), {"x"}, netcdf4::Type::Float);
+                 }
+                 file.close();
+               })});
+  results.add({"define", "add_variable_x100", "netcdfhpp_transaction", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 auto file = netcdf4::File::create(path);
+                 auto tx = file.define();
+                 tx.add_dimension("x", 100);
+                 for (size_t i = 0; i < n_vars; ++i) {
+                   tx.add_variable("var_" + std::to_string(i), {"x"}, netcdf4::Type::Float);
+                 }
+                 tx.commit();
+                 file.close();
+               })});
+  results.add({"define", "add_variable_x100", "netcdf-c", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 int id = 0, dim_id = 0, var_id = 0;
+                 check(nc_create(path.c_str(), NC_CLOBBER | NC_NETCDF4, &id));
+                 check(nc_def_dim(id, "x", 100, &dim_id));
+                 for (size_t i = 0; i < n_vars; ++i) {
+                   std::string name = "var_" + std::to_string(i);
+                   check(nc_def_var(id, name.c_str(), NC_FLOAT, 1, &dim_id, &var_id));
+                 }
+                 check(nc_enddef(id));
+                 check(nc_close(id));
+               })});
+}
+
+void bench_data(bench::Results& results) {
+  std::string path = "bench_suite_data.nc";
+  size_t nx = 1000, ny = 1000;
+  create_data_file(path, nx, ny);
+
+  auto file = netcdf4::File::open(path);
+  auto field = file.get_variable("field");
+  auto scalar = file.get_variable("scalar");
+  int id = file.get_id();
+  int field_id = field.get_id();
+  int scalar_id = scalar.get_id();
+  std::vector<float> data(nx * ny);
+
+  size_t n = calls(20);
+  results.add({"variable", "read_full_1000x1000", "netcdfhpp", n,
+               bench::measure(n, n_repetitions, [&]() { field.read(data.data()); })});
+  results.add({"variable", "read_full_1000x1000", "netcdf-c", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 check(nc_get_var_float(id, field_id, data.data()));
+               })});
+  results.add({"variable", "write_full_1000x1000", "netcdfhpp", n,
+               bench::measure(n, n_repetitions, [&]() { field.write(data.data()); })});
+  results.add({"variable", "write_full_1000x1000", "netcdf-c", n,
+               bench::measure(n, n_repetitions, [&]() {
+                 check(nc_put_var_float(id, field_id, data.data()));
+               })});
+
+  std::vector<std::pair<size_t, size_t>> shapes = {
+      {1, 1}, {16, 16}, {256, 256}, {1, 1000}, {1000, 1}};
+  for (auto& shape : shapes) {
+    std::string name = "read_hyperslab_" + std::to_string(shape.first) + "x" +
+                       std::to_string(shape.second);
+    size_t n_slab = calls(shape.first * shape.second > 10000 ? 100 : 10000);
+    std::array<size_t, 2> counts = {shape.first, shape.second};
+    size_t i = 0;
+    auto starts = [&]() {
+      ++i;
+      return std::array<size_t, 2>{(i * 7) % (nx - shape.first + 1),
+                                   (i * 13) % (ny - shape.second + 1)};
+    };
+    results.add({"variable", name, "netcdfhpp", n_slab,
+                 bench::measure(n_slab, n_repetitions, [&]() {
+                   field.read(starts(), counts, data.data());
+                 })});
+    results.add({"variable", name, "netcdf-c", n_slab,
+                 bench::measure(n_slab, n_repetitions, [&]() {
+                   auto s = starts();
+                   check(nc_get_vara_float(id, field_id, s.data(), counts.data(), data.data()));
+                 })});
+  }
+
+  size_t n_scalar = calls(100000);
+  int value = 0;
+  results.add({"variable", "read_scalar", "netcdfhpp", n_scalar,
+               bench::measure(n_scalar, n_repetitions, [&]() {
+                 value += scalar.read<int>();
+               })});
+  results.add({"variable", "read_scalar", "netcdf-c", n_scalar,
+               bench::measure(n_scalar, n_repetitions, [&]() {
+                 int v = 0;
+                 check(nc_get_var1_int(id, scalar_id, netcdf4::detail::zero_index, &v));
+                 value += v;
+               })});
+  file.close();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string json_path = "", csv_path = "";
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--json" && i + 1 < argc) {
+      json_path = argv[++i];
+    } else if (arg == "--csv" && i + 1 < argc) {
+      csv_path = argv[++i];
+    } else if (arg == "--quick") {
+      scale = 10;
+      n_repetitions = 3;
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--json <file>] [--csv <file>] [--quick]" << std::endl;
+      return 1;
+    }
+  }
+
+  bench::Results results;
+  bench_files(results);
+  bench_definitions(results);
+  bench_data(results);
+
+  if (json_path != "") {
+    results.write_json(json_path, nc_inq_libvers());
+  }
+  if (csv_path != "") {
+    results.write_csv(csv_path);
+  }
+  return 0;
+}
@@ -0,0 +1,110 @@
+/** Concurrent writes of tiles from multiple producer threads.
+ *
+ * Each of n producers computes a band of rows of a global field per
+ * time step and writes it to the same variable, either directly while
+ * holding a global mutex or through a WriteQueue followed by a flush
+ * at the end of the step. Reports the median throughput for 1 to 64
+ * producers.
+ */
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <netcdf.hpp>
+#include "bench_common.hpp"
+
+namespace {
+
+constexpr size_t n_rows = 1024;
+constexpr size_t n_columns = 1024;
+
+netcdf4::File create_file(std::string name) {
+  auto file = netcdf4::File::create(name);
+  auto tx = file.define();
+  tx.add_dimension("time");
+  tx.add_dimension("y", static_cast<int>(n_rows));
+  tx.add_dimension("x", static_cast<int>(n_columns));
+  netcdf4::StorageOptions storage{};
+  storage.chunk_sizes = {1, 16, n_columns};
+  tx.add_variable("field", {"time", "y", "x"}, netcdf4::Type::Float, storage);
+  tx.commit();
+  return file;
+}
+
+// Computes a band of rows of the field at the given time step.
+std::vector<float> compute_tile(size_t step, size_t first_row, size_t n_tile_rows) {
+  std::vector<float> tile(n_tile_rows * n_columns);
+  for (size_t i = 0; i < n_tile_rows; ++i) {
+    for (size_t j = 0; j < n_columns; ++j) {
+      float y = static_cast<float>(first_row + i);
+      float x = static_cast<float>(j);
+      tile[i * n_columns + j] = std::sin(0.01f * (x + y + static_cast<float>(step)));
+    }
+  }
+  return tile;
+}
+
+// Runs n_producers threads per time step that each call produce with
+// the first row and number of rows of their tile.
+template <typename F>
+void run_producers(size_t n_producers, F&& produce) {
+  std::vector<std::thread> threads;
+  size_t n_tile_rows = n_rows / n_producers;
+  for (size_t p = 0; p < n_producers; ++p) {
+    threads.emplace_back([&produce, p, n_tile_rows] { produce(p * n_tile_rows, n_tile_rows); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace
+
+int main() {
+  size_t n_steps = 16;
+  size_t n_repetitions = 5;
+  std::string name = "bench_write_queue.nc";
+  double megabytes = n_steps * n_rows * n_columns * sizeof(float) / 1e6;
+
+  for (size_t n_producers : {1, 2, 4, 8, 16, 32, 64}) {
+    std::cout << n_producers << " producers:" << std::endl;
+
+    double ms = 1e-6 * bench::measure(1, n_repetitions, [&]() {
+      auto file = create_file(name);
+      auto var = file.get_variable("field");
+      std::mutex mutex;
+      for (size_t step = 0; step < n_steps; ++step) {
+        run_producers(n_producers, [&](size_t first_row, size_t n_tile_rows) {
+          auto tile = compute_tile(step, first_row, n_tile_rows);
+          std::lock_guard<std::mutex> lock(mutex);
+          var.write(std::array<size_t, 3>{step, first_row, 0},
+                    std::array<size_t, 3>{1, n_tile_rows, n_columns},
+                    tile.data());
+        });
+      }
+      file.close();
+    }).median;
+    std::cout << "  mutex:       " << ms << " ms, " << megabytes / ms * 1e3
+              << " MB/s" << std::endl;
+
+    ms = 1e-6 * bench::measure(1, n_repetitions, [&]() {
+      auto file = create_file(name);
+      {
+        netcdf4::WriteQueue<float, 3> queue(file.get_variable("field"), 64 << 20);
+        for (size_t step = 0; step < n_steps; ++step) {
+          run_producers(n_producers, [&](size_t first_row, size_t n_tile_rows) {
+            queue.push({step, first_row, 0},
+                       {1, n_tile_rows, n_columns},
+                       compute_tile(step, first_row, n_tile_rows));
+          });
+        }
+        queue.flush();
+      }
+      file.close();
+    }).median;
+    std::cout << "  write queue: " << ms << " ms, " << megabytes / ms * 1e3
+              << " MB/s" << std::endl;
+  }
+  return 0;
+}
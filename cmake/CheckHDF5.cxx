@@ -0,0 +1,47 @@
+// Configure-time check that the HDF5 library found for NETCDFHPP_WITH_HDF5
+// is the one that the NetCDF-c library uses. HDF5 objects opened by one
+// copy of the library can't be used with another, so both must resolve to
+// a single shared libhdf5 in the process.
+#include <link.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <string>
+
+#include <hdf5.h>
+#include "netcdf.h"
+
+static int collect_hdf5(struct dl_phdr_info* info, size_t, void* data) {
+  const char* name = std::strrchr(info->dlpi_name, '/');
+  name = name ? name + 1 : info->dlpi_name;
+  // Skip the high-level library, e.g. libhdf5_hl.so or libhdf5_serial_hl.so.
+  if (std::strncmp(name, "libhdf5", 7) == 0 && !std::strstr(name, "_hl")) {
+    char path[PATH_MAX];
+    const char* resolved = realpath(info->dlpi_name, path);
+    static_cast<std::set<std::string>*>(data)->insert(
+        resolved ? resolved : info->dlpi_name);
+  }
+  return 0;
+}
+
+int main() {
+  // Make sure that libnetcdf and its dependencies are loaded.
+  std::printf("NetCDF %s", nc_inq_libvers());
+
+  // Aborts on mismatch of headers and library unless disabled through
+  // HDF5_DISABLE_VERSION_CHECK.
+  H5check_version(H5_VERS_MAJOR, H5_VERS_MINOR, H5_VERS_RELEASE);
+  unsigned major = 0, minor = 0, release = 0;
+  H5get_libversion(&major, &minor, &release);
+  std::printf(", HDF5 %u.%u.%u", major, minor, release);
+
+  std::set<std::string> libraries;
+  dl_iterate_phdr(collect_hdf5, &libraries);
+  for (auto& library : libraries) {
+    std::printf(", %s", library.c_str());
+  }
+  return libraries.size() > 1 ? 1 : 0;
+}
@@ -12,17 +12,463 @@
 #ifndef __NETCDF_HPP__
 #define __NETCDF_HPP__
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
+#ifdef NETCDFHPP_INSTRUMENTATION
+#include <chrono>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NETCDFHPP_HAS_MMAP
+#endif
+
+#ifdef NETCDFHPP_WITH_HDF5
+#include <hdf5.h>
+#include <zlib.h>
+#endif
+
 #include "netcdf.h"
+#include "netcdf_mem.h"
 
 namespace netcdf4 {
+
+////////////////////////////////////////////////////////////////////////////////
+// I/O instrumentation
+////////////////////////////////////////////////////////////////////////////////
+
+/// Whether calls into the NetCDF-c library are instrumented. Define
+/// NETCDFHPP_INSTRUMENTATION before including this header to enable
+/// instrumentation. When disabled, no statistics are recorded and the
+/// statistics API returns empty results.
+#ifdef NETCDFHPP_INSTRUMENTATION
+inline constexpr bool instrumentation_enabled = true;
+#else
+inline constexpr bool instrumentation_enabled = false;
+#endif
+
+/** Categories of NetCDF-c library calls. */
+enum class CallCategory {
+  /// Data transfer from a file (nc_get_var*).
+  Read = 0,
+  /// Data transfer to a file (nc_put_var*).
+  Write,
+  /// Metadata queries (nc_inq_*, nc_get_att*).
+  Inquire,
+  /// Definition of dimensions, variables, groups and attributes (nc_def_*,
+  /// nc_put_att*).
+  Define,
+  /// Transitions between define and data mode (nc_enddef, nc_redef).
+  ModeSwitch,
+  /// Flushing of buffers to disk (nc_sync).
+  Sync,
+  /// Creating, opening and closing files.
+  File,
+  /// Configuration of in-memory caches (nc_set_var_chunk_cache).
+  Cache
+};
+
+/// The number of call categories.
+inline constexpr size_t n_call_categories = 8;
+
+inline std::ostream& operator<<(std::ostream& out, CallCategory category) {
+  switch (category) {
+    case CallCategory::Read: out << "Read"; break;
+    case CallCategory::Write: out << "Write"; break;
+    case CallCategory::Inquire: out << "Inquire"; break;
+    case CallCategory::Define: out << "Define"; break;
+    case CallCategory::ModeSwitch: out << "ModeSwitch"; break;
+    case CallCategory::Sync: out << "Sync"; break;
+    case CallCategory::File: out << "File"; break;
+    case CallCategory::Cache: out << "Cache"; break;
+  }
+  return out;
+}
+
+/** Logarithmic latency histogram.
+ *
+ * Bin i counts calls that took between 2^(i - 1) and 2^i nanoseconds.
+ * The last bin also counts all slower calls.
+ */
+struct LatencyHistogram {
+  static constexpr size_t n_bins = 40;
+
+  /** Add a call to the histogram.
+   * @param ns The latency of the call in nanoseconds.
+   */
+  void add(uint64_t ns) {
+    bins[std::min<size_t>(std::bit_width(ns), n_bins - 1)] += 1;
+  }
+
+  LatencyHistogram& operator+=(const LatencyHistogram& other) {
+    for (size_t i = 0; i < n_bins; ++i) {
+      bins[i] += other.bins[i];
+    }
+    return *this;
+  }
+
+  std::array<uint64_t, n_bins> bins = {};
+};
+
+/** Statistics of a single category of library calls. */
+struct CallStats {
+  /** Record a library call.
+   * @param n_bytes The number of bytes transferred by the call.
+   * @param ns The latency of the call in nanoseconds.
+   */
+  void add(size_t n_bytes, uint64_t ns) {
+    calls += 1;
+    bytes += n_bytes;
+    total_ns += ns;
+    latency.add(ns);
+  }
+
+  CallStats& operator+=(const CallStats& other) {
+    calls += other.calls;
+    bytes += other.bytes;
+    total_ns += other.total_ns;
+    latency += other.latency;
+    return *this;
+  }
+
+  /// The number of calls.
+  uint64_t calls = 0;
+  /// The number of bytes transferred to or from the library.
+  uint64_t bytes = 0;
+  /// The total time spent in the calls in nanoseconds.
+  uint64_t total_ns = 0;
+  /// Histogram of the latencies of the calls.
+  LatencyHistogram latency;
+};
+
+/** Statistics of the library calls issued on a file or variable. */
+struct IOStats {
+  const CallStats& operator[](CallCategory category) const {
+    return categories[static_cast<size_t>(category)];
+  }
+  CallStats& operator[](CallCategory category) {
+    return categories[static_cast<size_t>(category)];
+  }
+
+  /// Statistics accumulated over all categories.
+  CallStats total() const {
+    CallStats result;
+    for (auto& stats : categories) {
+      result += stats;
+    }
+    return result;
+  }
+
+  IOStats& operator+=(const IOStats& other) {
+    for (size_t i = 0; i < n_call_categories; ++i) {
+      categories[i] += other.categories[i];
+    }
+    return *this;
+  }
+
+  std::array<CallStats, n_call_categories> categories = {};
+};
+
+/** A completed span of a traced operation. */
+struct TraceEvent {
+  /// The name of the operation, e.g. "Variable::read".
+  std::string name;
+  /// The category of the operation, e.g. "read".
+  std::string category;
+  /// Start of the span in nanoseconds since recording was started.
+  uint64_t start_ns = 0;
+  /// Duration of the span in nanoseconds.
+  uint64_t duration_ns = 0;
+  /// Index of the thread that executed the operation.
+  uint64_t thread = 0;
+  /// Arguments of the operation as JSON object.
+  std::string args = "{}";
+};
+
+namespace detail {
+
+// Escapes string for use in a JSON document.
+inline std::string json_escape(const std::string& text) {
+  std::string result;
+  result.reserve(text.size());
+  for (char c : text) {
+    switch (c) {
+      case '"': result += "\\\""; break;
+      case '\\': result += "\\\\"; break;
+      case '\n': result += "\\n"; break;
+      case '\t': result += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char code[7];
+          std::snprintf(code, sizeof(code), "\\u%04x", c);
+          result += code;
+        } else {
+          result += c;
+        }
+    }
+  }
+  return result;
+}
+
+}  // namespace detail
+
+/** Recorder for traces of NetCDF operations.
+ *
+ * While recording, opening and creating files, parsing groups, reading
+ * and writing variables and syncing files emit spans that are collected
+ * by the process-wide recorder. The recorded spans can be exported in
+ * the Chrome trace-event format, which can be loaded into trace viewers
+ * such as chrome://tracing or Perfetto.
+ *
+ * Tracing is part of the I/O instrumentation and requires
+ * NETCDFHPP_INSTRUMENTATION to be defined. Otherwise no spans are
+ * recorded.
+ */
+class TraceRecorder {
+ public:
+  /// The process-wide trace recorder.
+  static TraceRecorder& get() {
+    static TraceRecorder recorder;
+    return recorder;
+  }
+
+  /** Start recording.
+   *
+   * Discards previously recorded spans. Span start times are relative
+   * to the time recording was started.
+   */
+  void start() {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+    epoch_ = std::chrono::steady_clock::now();
+    recording_.store(true, std::memory_order_release);
+#endif
+  }
+
+  /// Stop recording. Recorded spans are kept until recording is restarted.
+  void stop() {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    recording_.store(false, std::memory_order_release);
+#endif
+  }
+
+  /// Whether spans are currently recorded.
+  bool is_recording() const {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    return recording_.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+  }
+
+  /// Copy of the recorded spans.
+  std::vector<TraceEvent> get_events() {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+#else
+    return {};
+#endif
+  }
+
+  /** Write recorded spans in Chrome trace-event format.
+   *
+   * @param out The stream to write the JSON document to.
+   */
+  void write_chrome_trace(std::ostream& out) {
+    auto events = get_events();
+    out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    for (size_t i = 0; i < events.size(); ++i) {
+      auto& event = events[i];
+      out << (i ? ",\n" : "\n");
+      out << "{\"name\": \"" << detail::json_escape(event.name) << "\", "
+          << "\"cat\": \"" << detail::json_escape(event.category) << "\", "
+          << "\"ph\": \"X\", "
+          << "\"ts\": " << event.start_ns / 1000 << "."
+          << std::to_string(1000 + event.start_ns % 1000).substr(1) << ", "
+          << "\"dur\": " << event.duration_ns / 1000 << "."
+          << std::to_string(1000 + event.duration_ns % 1000).substr(1) << ", "
+          << "\"pid\": 1, \"tid\": " << event.thread << ", "
+          << "\"args\": " << event.args << "}";
+    }
+    out << "\n]}\n";
+  }
+
+  /** Write recorded spans to file in Chrome trace-event format.
+   *
+   * @param path The path of the JSON file to write.
+   */
+  void write_chrome_trace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+      throw std::runtime_error("Could not open trace file " + path + ".");
+    }
+    write_chrome_trace(out);
+  }
+
+#ifdef NETCDFHPP_INSTRUMENTATION
+  /** Add completed span.
+   *
+   * @param event The span. Its start time is set from the given
+   *     time point.
+   * @param start The time at which the operation started.
+   */
+  void add(TraceEvent event, std::chrono::steady_clock::time_point start) {
+    auto end = std::chrono::steady_clock::now();
+    static std::atomic<uint64_t> n_threads{0};
+    thread_local uint64_t thread = n_threads++;
+    event.thread = thread;
+    event.duration_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!is_recording()) {
+      return;
+    }
+    auto offset = std::max(start, epoch_) - epoch_;
+    event.start_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(offset).count();
+    events_.push_back(std::move(event));
+  }
+
+ private:
+  std::atomic<bool> recording_{false};
+  std::mutex mutex_;
+  std::chrono::steady_clock::time_point epoch_;
+  std::vector<TraceEvent> events_;
+#endif
+};
+
+namespace detail {
+
+/** Span of a traced operation.
+ *
+ * Records the time between its construction and destruction in the
+ * trace recorder, if recording was active at construction. Arguments
+ * should only be added if the span is active, which avoids formatting
+ * them when tracing is disabled.
+ */
+class TraceSpan {
+ public:
+  TraceSpan([[maybe_unused]] const char* name,
+            [[maybe_unused]] const char* category) {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    if (TraceRecorder::get().is_recording()) {
+      active_ = true;
+      event_.name = name;
+      event_.category = category;
+      start_ = std::chrono::steady_clock::now();
+    }
+#endif
+  }
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  ~TraceSpan() {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    if (active_) {
+      if (!args_.empty()) {
+        event_.args = "{" + args_ + "}";
+      }
+      TraceRecorder::get().add(std::move(event_), start_);
+    }
+#endif
+  }
+
+  /// Whether the span is recorded.
+  explicit operator bool() const {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    return active_;
+#else
+    return false;
+#endif
+  }
+
+#ifdef NETCDFHPP_INSTRUMENTATION
+  /// Add string argument.
+  void add_arg(const char* key, const std::string& value) {
+    add_key(key);
+    args_ += "\"" + json_escape(value) + "\"";
+  }
+
+  /// Add integer argument.
+  void add_arg(const char* key, size_t value) {
+    add_key(key);
+    args_ += std::to_string(value);
+  }
+
+  /// Add array argument.
+  void add_arg(const char* key, const size_t* values, size_t n) {
+    add_key(key);
+    args_ += "[";
+    for (size_t i = 0; i < n; ++i) {
+      args_ += (i ? ", " : "") + std::to_string(values[i]);
+    }
+    args_ += "]";
+  }
+
+ private:
+  void add_key(const char* key) {
+    args_ += (args_.empty() ? "\"" : ", \"");
+    args_ += key;
+    args_ += "\": ";
+  }
+
+  bool active_ = false;
+  std::string args_;
+  TraceEvent event_;
+  std::chrono::steady_clock::time_point start_;
+#else
+  void add_arg(const char*, const std::string&) {}
+  void add_arg(const char*, size_t) {}
+  void add_arg(const char*, const size_t*, size_t) {}
+#endif
+};
+
+}  // namespace detail
+
+#ifdef NETCDFHPP_HAS_MMAP
+class MappedFile;
+#endif
+
 namespace detail {
 
+#if defined(NETCDFHPP_WITH_HDF5) && defined(NETCDFHPP_HAS_MMAP)
+struct ChunkIndex;
+#endif
+
 /** Handle NetCDF error
  *
  * Takes a NetCDF error code returned from a NetCDF library call and
@@ -42,40 +488,234 @@ inline void handle_error(std::string error_message, int error_code) {
   }
 }
 
+/** Handle NetCDF error
+ *
+ * Overload for string literals that avoids constructing the error
+ * message unless an error occurred.
+ *
+ * @param error_message Additional error message to display
+ *        before the NetCDF error.
+ * @param The NetCDF error code returned by the library call.
+ */
+inline void handle_error(const char* error_message, int error_code) {
+  if (error_code != NC_NOERR) {
+    handle_error(std::string(error_message), error_code);
+  }
+}
+
+#ifdef NETCDFHPP_INSTRUMENTATION
+/** I/O statistics of a file.
+ *
+ * Holds the statistics of all library calls issued on a file as well
+ * as the statistics of the calls issued on each of its variables.
+ * Variables are identified by the IDs of their parent group and the
+ * variable ID.
+ */
+struct FileStats {
+  void add(CallCategory category,
+           int parent_id,
+           int var_id,
+           size_t bytes,
+           uint64_t ns) {
+    std::lock_guard<std::mutex> lock(mutex);
+    file[category].add(bytes, ns);
+    if (var_id != NC_GLOBAL) {
+      variables[{parent_id, var_id}][category].add(bytes, ns);
+    }
+  }
+
+  IOStats get_file_stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return file;
+  }
+
+  IOStats get_variable_stats(int parent_id, int var_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = variables.find({parent_id, var_id});
+    if (found == variables.end()) {
+      return {};
+    }
+    return found->second;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    file = {};
+    variables.clear();
+  }
+
+  void reset_variable(int parent_id, int var_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    variables.erase({parent_id, var_id});
+  }
+
+  std::mutex mutex;
+  IOStats file;
+  std::map<std::pair<int, int>, IOStats> variables;
+};
+#endif
+
 /** NetCDF file ID capsule.
  *
- * This wrapper struct manages the lifetime of a netcdf file.
+ * This wrapper struct manages the lifetime of a netcdf file and keeps
+ * track of whether the file is in define or data mode. Tracking the
+ * mode on the C++ side avoids issuing nc_enddef or nc_redef calls to
+ * the NetCDF-c library when no mode transition is required.
  */
 struct FileID {
   ~FileID() { close(); }
 
   void close() {
     if (open) {
-      int error = nc_close(id);
+      int error = instrument(CallCategory::File, [&] { return nc_close(id); });
       detail::handle_error("Error closing file: ", error);
       open = false;
     }
   }
 
+  /** Close in-memory file and retrieve its contents.
+   *
+   * @param memio Struct that receives the memory block holding the file.
+   *     The caller takes ownership of the memory.
+   */
+  void close_to_memory(NC_memio& memio) {
+    if (!open) {
+      throw std::runtime_error("Cannot retrieve contents of closed file.");
+    }
+    if (!in_memory) {
+      throw std::runtime_error("Only in-memory files can be closed to memory.");
+    }
+    int error = instrument(CallCategory::File, [&] {
+      return nc_close_memio(id, &memio);
+    });
+    detail::handle_error("Error closing in-memory file: ", error);
+    open = false;
+  }
+
+  /** Ensure that file is in data mode.
+   *
+   * Only calls into the NetCDF-c library if the file is currently
+   * in define mode.
+   */
+  void enter_data_mode() {
+    if (define_mode) {
+      int error = instrument(CallCategory::ModeSwitch, [&] { return nc_enddef(id); });
+      if (error != NC_ENOTINDEFINE) {
+        detail::handle_error("Error leaving define mode: ", error);
+      }
+      define_mode = false;
+    }
+  }
+
+  /** Ensure that file is in define mode.
+   *
+   * Only calls into the NetCDF-c library if the file is currently
+   * in data mode.
+   */
+  void enter_define_mode() {
+    if (!define_mode) {
+      assert_writable();
+      int error = instrument(CallCategory::ModeSwitch, [&] { return nc_redef(id); });
+      if (error != NC_EINDEFINE) {
+        detail::handle_error("Error (re)entering define mode: ", error);
+      }
+      define_mode = true;
+    }
+  }
+
+  /** Ensure that file may be modified.
+   *
+   * @throw std::runtime_error if the file was opened read-only.
+   */
+  void assert_writable() const {
+    if (read_only) {
+      throw std::runtime_error("Cannot modify file opened in read-only mode.");
+    }
+  }
+
+  /** Issue an instrumented library call.
+   *
+   * In instrumented builds, times the call and adds it to the statistics
+   * of the file and, if var_id refers to a variable, of the variable.
+   * Otherwise, simply forwards the call.
+   *
+   * @param category The category of the call.
+   * @param call Callable that issues the library call and returns its
+   *        error code.
+   * @param parent_id The ID of the group the call refers to.
+   * @param var_id The ID of the variable the call refers to or NC_GLOBAL.
+   * @param bytes The number of bytes transferred by the call.
+   * @return The error code returned by the call.
+   */
+  template <typename F>
+  int instrument([[maybe_unused]] CallCategory category,
+                 F&& call,
+                 [[maybe_unused]] int parent_id = 0,
+                 [[maybe_unused]] int var_id = NC_GLOBAL,
+                 [[maybe_unused]] size_t bytes = 0) {
+    // Only calls that may change the bytes of the file invalidate its
+    // mapping.
+    if (category == CallCategory::Write || category == CallCategory::Define ||
+        category == CallCategory::ModeSwitch) {
+      ++modifications;
+    }
+#ifdef NETCDFHPP_INSTRUMENTATION
+    auto start = std::chrono::steady_clock::now();
+    int error = call();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+    stats.add(category, parent_id, var_id, bytes, ns);
+    return error;
+#else
+    return call();
+#endif
+  }
+
   operator int() { return id; }
 
   int id = 0;
   bool open = false;
+  /// Whether the file is currently in define mode.
+  bool define_mode = false;
+  /// Whether to parse the complete group tree when the file is opened.
+  bool eager_parsing = false;
+  /// Whether the file was opened read-only. Read-only files never enter
+  /// define mode, so data access never requires a mode transition.
+  bool read_only = false;
+  /// Whether the file was created in memory and has no backing file.
+  bool in_memory = false;
+  /// Memory backing a file that was opened from memory. Kept alive until
+  /// the file is destroyed.
+  std::shared_ptr<const void> memory = nullptr;
+  /// The number of calls that may have modified the file.
+  size_t modifications = 0;
+#ifdef NETCDFHPP_HAS_MMAP
+  /// Mapping of the file through which variables access their data
+  /// directly. Renewed when the file was modified after it was mapped.
+  std::shared_ptr<const MappedFile> mapping = nullptr;
+  /// The number of modifications when the file was mapped.
+  size_t mapped_modifications = 0;
+  /// The path of the mapped file.
+  std::string mapped_path = "";
+#endif
+#if defined(NETCDFHPP_WITH_HDF5) && defined(NETCDFHPP_HAS_MMAP)
+  /// Chunk indices of variables read through the mapping, identified by
+  /// group and variable ID. Null for variables whose chunks can't be
+  /// read directly. Cleared when the file is mapped again.
+  std::map<std::pair<int, int>, std::shared_ptr<const ChunkIndex>> chunk_indices = {};
+#endif
+#ifdef NETCDFHPP_INSTRUMENTATION
+  /// Statistics of the library calls issued on the file.
+  FileStats stats;
+#endif
 };
 
-inline void assert_write_mode(int nc_id) {
-  int error = nc_enddef(nc_id);
-  if (error != NC_ENOTINDEFINE) {
-    detail::handle_error("Error leaving define mode: ", error);
-  }
-}
+/// Index of the first element of a variable of any rank.
+inline constexpr size_t zero_index[NC_MAX_VAR_DIMS] = {};
 
-inline void assert_define_mode(int nc_id) {
-  int error = nc_redef(nc_id);
-  if (error != NC_EINDEFINE) {
-    detail::handle_error("Error (re)entering define mode: ", error);
-  }
-}
+inline void assert_write_mode(FileID& file) { file.enter_data_mode(); }
+
+inline void assert_define_mode(FileID& file) { file.enter_define_mode(); }
 
 }  // namespace detail
 
@@ -91,11 +731,49 @@ enum class CreationMode {
 };
 
 enum class OpenMode {
+  /// Open file for reading only. Mutating calls throw an exception.
+  ReadOnly = NC_NOWRITE,
   Write = NC_WRITE,
   Share = NC_SHARE,
   WriteShare = NC_WRITE | NC_SHARE
 };
 
+/// Whether the data of new variables is pre-filled with their fill value.
+enum class FillMode {
+  /// Keep the current setting, which is prefilling unless changed.
+  Default = -1,
+  /// Prefill data with the fill value before it is written.
+  Fill = NC_FILL,
+  /// Don't prefill data. Elements that are never written are undefined,
+  /// so this should only be used for variables that are written entirely.
+  NoFill = NC_NOFILL
+};
+
+/// Whether the group tree is parsed when a file is opened or on first access.
+enum class ParseMode {
+  /// Resolve groups, variables and dimensions on first access.
+  Lazy,
+  /// Parse the complete group tree when the file is opened.
+  Eager
+};
+
+/// How data is converted between NetCDF and C++ types.
+enum class Conversion {
+  /// Read or write data in the variable's type and convert it in memory.
+  Native,
+  /// Let the NetCDF-c library convert the data.
+  Library
+};
+
+/// Storage layout of a variable's data.
+enum class Layout {
+  /// Leave the choice of the layout to the NetCDF-c library.
+  Default = -1,
+  Chunked = NC_CHUNKED,
+  Contiguous = NC_CONTIGUOUS,
+  Compact = NC_COMPACT
+};
+
 enum class Type {
   NotAType = NC_NAT,
   Byte = NC_BYTE,
@@ -174,9 +852,89 @@ inline std::ostream& operator<<(std::ostream& out, const Type& t) {
   return out;
 }
 
+/** NetCDF type properties.
+ *
+ * Specializations of this struct map C++ types to the corresponding
+ * NetCDF type and the NetCDF-c functions used to read and write them.
+ */
 template <typename T>
 struct TypeProperties;
 
+template <>
+struct TypeProperties<signed char> {
+  static constexpr Type value = Type::Byte;
+  static constexpr auto write = &nc_put_var_schar;
+  static constexpr auto write_array = &nc_put_vara_schar;
+  static constexpr auto write_value = &nc_put_var1_schar;
+  static constexpr auto write_strided = &nc_put_vars_schar;
+  static constexpr auto write_mapped = &nc_put_varm_schar;
+  static constexpr auto read = &nc_get_var_schar;
+  static constexpr auto read_array = &nc_get_vara_schar;
+  static constexpr auto read_value = &nc_get_var1_schar;
+  static constexpr auto read_strided = &nc_get_vars_schar;
+  static constexpr auto read_mapped = &nc_get_varm_schar;
+};
+
+template <>
+struct TypeProperties<char> {
+  static constexpr Type value = Type::Char;
+  static constexpr auto write = &nc_put_var_text;
+  static constexpr auto write_array = &nc_put_vara_text;
+  static constexpr auto write_value = &nc_put_var1_text;
+  static constexpr auto write_strided = &nc_put_vars_text;
+  static constexpr auto write_mapped = &nc_put_varm_text;
+  static constexpr auto read = &nc_get_var_text;
+  static constexpr auto read_array = &nc_get_vara_text;
+  static constexpr auto read_value = &nc_get_var1_text;
+  static constexpr auto read_strided = &nc_get_vars_text;
+  static constexpr auto read_mapped = &nc_get_varm_text;
+};
+
+template <>
+struct TypeProperties<unsigned char> {
+  static constexpr Type value = Type::UByte;
+  static constexpr auto write = &nc_put_var_uchar;
+  static constexpr auto write_array = &nc_put_vara_uchar;
+  static constexpr auto write_value = &nc_put_var1_uchar;
+  static constexpr auto write_strided = &nc_put_vars_uchar;
+  static constexpr auto write_mapped = &nc_put_varm_uchar;
+  static constexpr auto read = &nc_get_var_uchar;
+  static constexpr auto read_array = &nc_get_vara_uchar;
+  static constexpr auto read_value = &nc_get_var1_uchar;
+  static constexpr auto read_strided = &nc_get_vars_uchar;
+  static constexpr auto read_mapped = &nc_get_varm_uchar;
+};
+
+template <>
+struct TypeProperties<short> {
+  static constexpr Type value = Type::Short;
+  static constexpr auto write = &nc_put_var_short;
+  static constexpr auto write_array = &nc_put_vara_short;
+  static constexpr auto write_value = &nc_put_var1_short;
+  static constexpr auto write_strided = &nc_put_vars_short;
+  static constexpr auto write_mapped = &nc_put_varm_short;
+  static constexpr auto read = &nc_get_var_short;
+  static constexpr auto read_array = &nc_get_vara_short;
+  static constexpr auto read_value = &nc_get_var1_short;
+  static constexpr auto read_strided = &nc_get_vars_short;
+  static constexpr auto read_mapped = &nc_get_varm_short;
+};
+
+template <>
+struct TypeProperties<unsigned short> {
+  static constexpr Type value = Type::UShort;
+  static constexpr auto write = &nc_put_var_ushort;
+  static constexpr auto write_array = &nc_put_vara_ushort;
+  static constexpr auto write_value = &nc_put_var1_ushort;
+  static constexpr auto write_strided = &nc_put_vars_ushort;
+  static constexpr auto write_mapped = &nc_put_varm_ushort;
+  static constexpr auto read = &nc_get_var_ushort;
+  static constexpr auto read_array = &nc_get_vara_ushort;
+  static constexpr auto read_value = &nc_get_var1_ushort;
+  static constexpr auto read_strided = &nc_get_vars_ushort;
+  static constexpr auto read_mapped = &nc_get_varm_ushort;
+};
+
 template <>
 struct TypeProperties<int> {
   static constexpr Type value = Type::Int;
@@ -184,10 +942,72 @@ struct TypeProperties<int> {
   static constexpr auto write_array = &nc_put_vara_int;
   static constexpr auto write_value = &nc_put_var1_int;
   static constexpr auto write_strided = &nc_put_vars_int;
+  static constexpr auto write_mapped = &nc_put_varm_int;
   static constexpr auto read = &nc_get_var_int;
   static constexpr auto read_array = &nc_get_vara_int;
   static constexpr auto read_value = &nc_get_var1_int;
   static constexpr auto read_strided = &nc_get_vars_int;
+  static constexpr auto read_mapped = &nc_get_varm_int;
+};
+
+template <>
+struct TypeProperties<unsigned int> {
+  static constexpr Type value = Type::UInt;
+  static constexpr auto write = &nc_put_var_uint;
+  static constexpr auto write_array = &nc_put_vara_uint;
+  static constexpr auto write_value = &nc_put_var1_uint;
+  static constexpr auto write_strided = &nc_put_vars_uint;
+  static constexpr auto write_mapped = &nc_put_varm_uint;
+  static constexpr auto read = &nc_get_var_uint;
+  static constexpr auto read_array = &nc_get_vara_uint;
+  static constexpr auto read_value = &nc_get_var1_uint;
+  static constexpr auto read_strided = &nc_get_vars_uint;
+  static constexpr auto read_mapped = &nc_get_varm_uint;
+};
+
+template <>
+struct TypeProperties<long> {
+  static constexpr Type value = sizeof(long) == 8 ? Type::Int64 : Type::Int;
+  static constexpr auto write = &nc_put_var_long;
+  static constexpr auto write_array = &nc_put_vara_long;
+  static constexpr auto write_value = &nc_put_var1_long;
+  static constexpr auto write_strided = &nc_put_vars_long;
+  static constexpr auto write_mapped = &nc_put_varm_long;
+  static constexpr auto read = &nc_get_var_long;
+  static constexpr auto read_array = &nc_get_vara_long;
+  static constexpr auto read_value = &nc_get_var1_long;
+  static constexpr auto read_strided = &nc_get_vars_long;
+  static constexpr auto read_mapped = &nc_get_varm_long;
+};
+
+template <>
+struct TypeProperties<long long> {
+  static constexpr Type value = Type::Int64;
+  static constexpr auto write = &nc_put_var_longlong;
+  static constexpr auto write_array = &nc_put_vara_longlong;
+  static constexpr auto write_value = &nc_put_var1_longlong;
+  static constexpr auto write_strided = &nc_put_vars_longlong;
+  static constexpr auto write_mapped = &nc_put_varm_longlong;
+  static constexpr auto read = &nc_get_var_longlong;
+  static constexpr auto read_array = &nc_get_vara_longlong;
+  static constexpr auto read_value = &nc_get_var1_longlong;
+  static constexpr auto read_strided = &nc_get_vars_longlong;
+  static constexpr auto read_mapped = &nc_get_varm_longlong;
+};
+
+template <>
+struct TypeProperties<unsigned long long> {
+  static constexpr Type value = Type::UInt64;
+  static constexpr auto write = &nc_put_var_ulonglong;
+  static constexpr auto write_array = &nc_put_vara_ulonglong;
+  static constexpr auto write_value = &nc_put_var1_ulonglong;
+  static constexpr auto write_strided = &nc_put_vars_ulonglong;
+  static constexpr auto write_mapped = &nc_put_varm_ulonglong;
+  static constexpr auto read = &nc_get_var_ulonglong;
+  static constexpr auto read_array = &nc_get_vara_ulonglong;
+  static constexpr auto read_value = &nc_get_var1_ulonglong;
+  static constexpr auto read_strided = &nc_get_vars_ulonglong;
+  static constexpr auto read_mapped = &nc_get_varm_ulonglong;
 };
 
 template <>
@@ -197,10 +1017,12 @@ struct TypeProperties<float> {
   static constexpr auto write_array = &nc_put_vara_float;
   static constexpr auto write_value = &nc_put_var1_float;
   static constexpr auto write_strided = &nc_put_vars_float;
+  static constexpr auto write_mapped = &nc_put_varm_float;
   static constexpr auto read = &nc_get_var_float;
   static constexpr auto read_array = &nc_get_vara_float;
   static constexpr auto read_value = &nc_get_var1_float;
   static constexpr auto read_strided = &nc_get_vars_float;
+  static constexpr auto read_mapped = &nc_get_varm_float;
 };
 
 template <>
@@ -210,25 +1032,770 @@ struct TypeProperties<double> {
   static constexpr auto write_array = &nc_put_vara_double;
   static constexpr auto write_value = &nc_put_var1_double;
   static constexpr auto write_strided = &nc_put_vars_double;
+  static constexpr auto write_mapped = &nc_put_varm_double;
   static constexpr auto read = &nc_get_var_double;
   static constexpr auto read_array = &nc_get_vara_double;
   static constexpr auto read_value = &nc_get_var1_double;
   static constexpr auto read_strided = &nc_get_vars_double;
+  static constexpr auto read_mapped = &nc_get_varm_double;
 };
 
-template <>
-struct TypeProperties<char> {
-  static constexpr Type value = Type::Char;
-  static constexpr auto write = &nc_put_var_schar;
-  static constexpr auto write_array = &nc_put_vara_schar;
-  static constexpr auto write_value = &nc_put_var1_schar;
-  static constexpr auto write_strided = &nc_put_vars_schar;
-  static constexpr auto read = &nc_get_var_schar;
-  static constexpr auto read_array = &nc_get_vara_schar;
-  static constexpr auto read_value = &nc_get_var1_schar;
-  static constexpr auto read_strided = &nc_get_vars_schar;
+namespace detail {
+
+/** Forwarded type properties.
+ *
+ * Type properties for a C++ type T that has no dedicated NetCDF-c
+ * functions but shares its representation with type Target.
+ */
+template <typename T, typename Target>
+struct ForwardedTypeProperties {
+  static_assert(sizeof(T) == sizeof(Target),
+                "Forwarded types must have identical size.");
+  using Traits = TypeProperties<Target>;
+  static constexpr Type value = Traits::value;
+  static int write(int nc_id, int var_id, const T* data) {
+    return Traits::write(nc_id, var_id, reinterpret_cast<const Target*>(data));
+  }
+  static int write_array(int nc_id,
+                         int var_id,
+                         const size_t* starts,
+                         const size_t* counts,
+                         const T* data) {
+    return Traits::write_array(
+        nc_id, var_id, starts, counts, reinterpret_cast<const Target*>(data));
+  }
+  static int write_value(int nc_id, int var_id, const size_t* index, const T* data) {
+    return Traits::write_value(
+        nc_id, var_id, index, reinterpret_cast<const Target*>(data));
+  }
+  static int write_strided(int nc_id,
+                           int var_id,
+                           const size_t* starts,
+                           const size_t* counts,
+                           const ptrdiff_t* strides,
+                           const T* data) {
+    return Traits::write_strided(nc_id,
+                                 var_id,
+                                 starts,
+                                 counts,
+                                 strides,
+                                 reinterpret_cast<const Target*>(data));
+  }
+  static int write_mapped(int nc_id,
+                          int var_id,
+                          const size_t* starts,
+                          const size_t* counts,
+                          const ptrdiff_t* strides,
+                          const ptrdiff_t* map,
+                          const T* data) {
+    return Traits::write_mapped(nc_id,
+                                var_id,
+                                starts,
+                                counts,
+                                strides,
+                                map,
+                                reinterpret_cast<const Target*>(data));
+  }
+  static int read(int nc_id, int var_id, T* data) {
+    return Traits::read(nc_id, var_id, reinterpret_cast<Target*>(data));
+  }
+  static int read_array(int nc_id,
+                        int var_id,
+                        const size_t* starts,
+                        const size_t* counts,
+                        T* data) {
+    return Traits::read_array(
+        nc_id, var_id, starts, counts, reinterpret_cast<Target*>(data));
+  }
+  static int read_value(int nc_id, int var_id, const size_t* index, T* data) {
+    return Traits::read_value(nc_id, var_id, index, reinterpret_cast<Target*>(data));
+  }
+  static int read_strided(int nc_id,
+                          int var_id,
+                          const size_t* starts,
+                          const size_t* counts,
+                          const ptrdiff_t* strides,
+                          T* data) {
+    return Traits::read_strided(
+        nc_id, var_id, starts, counts, strides, reinterpret_cast<Target*>(data));
+  }
+  static int read_mapped(int nc_id,
+                         int var_id,
+                         const size_t* starts,
+                         const size_t* counts,
+                         const ptrdiff_t* strides,
+                         const ptrdiff_t* map,
+                         T* data) {
+    return Traits::read_mapped(
+        nc_id, var_id, starts, counts, strides, map, reinterpret_cast<Target*>(data));
+  }
+};
+
+}  // namespace detail
+
+template <>
+struct TypeProperties<unsigned long>
+    : detail::ForwardedTypeProperties<
+          unsigned long,
+          std::conditional_t<sizeof(unsigned long) == sizeof(unsigned long long),
+                             unsigned long long,
+                             unsigned int>> {};
+
+/** Type properties of NetCDF strings.
+ *
+ * Strings are represented by C strings. Strings that are read from
+ * a variable are allocated by the NetCDF-c library and must be freed
+ * using nc_free_string.
+ */
+template <>
+struct TypeProperties<char*> {
+  static constexpr Type value = Type::String;
+  static int write(int nc_id, int var_id, char* const* data) {
+    return nc_put_var_string(nc_id, var_id, const_cast<const char**>(data));
+  }
+  static int write_array(int nc_id,
+                         int var_id,
+                         const size_t* starts,
+                         const size_t* counts,
+                         char* const* data) {
+    return nc_put_vara_string(
+        nc_id, var_id, starts, counts, const_cast<const char**>(data));
+  }
+  static int write_value(int nc_id, int var_id, const size_t* index, char* const* data) {
+    return nc_put_var1_string(nc_id, var_id, index, const_cast<const char**>(data));
+  }
+  static int write_strided(int nc_id,
+                           int var_id,
+                           const size_t* starts,
+                           const size_t* counts,
+                           const ptrdiff_t* strides,
+                           char* const* data) {
+    return nc_put_vars_string(
+        nc_id, var_id, starts, counts, strides, const_cast<const char**>(data));
+  }
+  static int write_mapped(int nc_id,
+                          int var_id,
+                          const size_t* starts,
+                          const size_t* counts,
+                          const ptrdiff_t* strides,
+                          const ptrdiff_t* map,
+                          char* const* data) {
+    return nc_put_varm_string(
+        nc_id, var_id, starts, counts, strides, map, const_cast<const char**>(data));
+  }
+  static constexpr auto read = &nc_get_var_string;
+  static constexpr auto read_array = &nc_get_vara_string;
+  static constexpr auto read_value = &nc_get_var1_string;
+  static constexpr auto read_strided = &nc_get_vars_string;
+  static constexpr auto read_mapped = &nc_get_varm_string;
+};
+
+/** C++ type corresponding to NetCDF type.
+ *
+ * Specializations of this struct map each atomic NetCDF type to the
+ * C++ type that is used to represent it in memory.
+ */
+template <Type type>
+struct NativeType;
+
+template <> struct NativeType<Type::Byte> { using type = signed char; };
+template <> struct NativeType<Type::Char> { using type = char; };
+template <> struct NativeType<Type::Short> { using type = short; };
+template <> struct NativeType<Type::Int> { using type = int; };
+template <> struct NativeType<Type::Float> { using type = float; };
+template <> struct NativeType<Type::Double> { using type = double; };
+template <> struct NativeType<Type::UByte> { using type = unsigned char; };
+template <> struct NativeType<Type::UShort> { using type = unsigned short; };
+template <> struct NativeType<Type::UInt> { using type = unsigned int; };
+template <> struct NativeType<Type::Int64> { using type = long long; };
+template <> struct NativeType<Type::UInt64> { using type = unsigned long long; };
+template <> struct NativeType<Type::String> { using type = char*; };
+
+/** Dispatch on NetCDF type.
+ *
+ * Resolves a NetCDF type that is only known at runtime to the corresponding
+ * C++ type and calls the given function with a std::type_identity tag
+ * of that type. Since the dispatch happens once per call, code inside
+ * the function is compiled for each concrete type separately.
+ *
+ * @param type The NetCDF type to dispatch on.
+ * @param f Generic function to call with the type tag.
+ * @return The result of the function call.
+ */
+template <typename F>
+decltype(auto) dispatch(Type type, F&& f) {
+  switch (type) {
+    case Type::Byte:
+      return f(std::type_identity<NativeType<Type::Byte>::type>{});
+    case Type::Char:
+      return f(std::type_identity<NativeType<Type::Char>::type>{});
+    case Type::Short:
+      return f(std::type_identity<NativeType<Type::Short>::type>{});
+    case Type::Int:
+      return f(std::type_identity<NativeType<Type::Int>::type>{});
+    case Type::Float:
+      return f(std::type_identity<NativeType<Type::Float>::type>{});
+    case Type::Double:
+      return f(std::type_identity<NativeType<Type::Double>::type>{});
+    case Type::UByte:
+      return f(std::type_identity<NativeType<Type::UByte>::type>{});
+    case Type::UShort:
+      return f(std::type_identity<NativeType<Type::UShort>::type>{});
+    case Type::UInt:
+      return f(std::type_identity<NativeType<Type::UInt>::type>{});
+    case Type::Int64:
+      return f(std::type_identity<NativeType<Type::Int64>::type>{});
+    case Type::UInt64:
+      return f(std::type_identity<NativeType<Type::UInt64>::type>{});
+    case Type::String:
+      return f(std::type_identity<NativeType<Type::String>::type>{});
+    default:
+      break;
+  }
+  std::stringstream msg;
+  msg << "Type " << type << " is not an atomic NetCDF type.";
+  throw std::runtime_error(msg.str());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Type conversion
+////////////////////////////////////////////////////////////////////////////////
+namespace detail {
+
+/** Convert array of values.
+ *
+ * Converts values element-wise using static_cast. Source and destination
+ * must not overlap, which allows the compiler to vectorize the loop.
+ *
+ * @param source Pointer to the values to convert.
+ * @param destination Pointer to the output array.
+ * @param n The number of values to convert.
+ */
+template <typename Source, typename Destination>
+inline void convert(const Source* __restrict__ source,
+                    Destination* __restrict__ destination,
+                    size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    destination[i] = static_cast<Destination>(source[i]);
+  }
+}
+
+/** Offset of packed values in destination buffer.
+ *
+ * Values of type Source that are converted in place into a buffer of
+ * type Destination are stored at the end of the buffer.
+ *
+ * @param destination The destination buffer.
+ * @param n The number of values in the buffer.
+ * @return Pointer to the start of the packed values.
+ */
+template <typename Source, typename Destination>
+inline Source* packed_values(Destination* destination, size_t n) {
+  static_assert(sizeof(Source) <= sizeof(Destination),
+                "In-place conversion requires destination type at least as "
+                "large as source type.");
+  char* bytes = reinterpret_cast<char*>(destination);
+  return reinterpret_cast<Source*>(
+      bytes + n * (sizeof(Destination) - sizeof(Source)));
+}
+
+/** Convert packed values in place.
+ *
+ * Converts n values of type Source stored at the end of the destination
+ * buffer (see packed_values) into values of type Destination that fill the
+ * buffer. Values are processed front to back in blocks, so that no packed
+ * value is overwritten before it has been converted.
+ *
+ * @param destination The destination buffer.
+ * @param n The number of values to convert.
+ * @param f Function applied block-wise as f(source, destination, n).
+ */
+template <typename Source, typename Destination, typename F>
+inline void convert_in_place(Destination* destination, size_t n, F&& f) {
+  constexpr size_t block_size = 1024;
+  const char* source =
+      reinterpret_cast<const char*>(packed_values<Source>(destination, n));
+  Source block[block_size];
+  for (size_t i = 0; i < n; i += block_size) {
+    size_t m = std::min(block_size, n - i);
+    std::memcpy(block, source + i * sizeof(Source), m * sizeof(Source));
+    f(block, destination + i, m);
+  }
+}
+
+}  // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// CF conventions
+////////////////////////////////////////////////////////////////////////////////
+/** CF packing parameters of a variable.
+ *
+ * Describes how packed values of a variable are decoded according to the
+ * CF conventions. Valid bounds are expressed in the packed representation
+ * of the data.
+ */
+struct CFPacking {
+  /// Factor by which packed values are multiplied.
+  double scale_factor = 1.0;
+  /// Offset added to scaled packed values.
+  double add_offset = 0.0;
+  /// Whether the variable has a fill value.
+  bool has_fill_value = false;
+  /// The fill value in packed representation.
+  double fill_value = 0.0;
+  /// Whether the variable has a missing value.
+  bool has_missing_value = false;
+  /// The missing value in packed representation.
+  double missing_value = 0.0;
+  /// Whether the variable has a lower bound for valid values.
+  bool has_valid_min = false;
+  /// The smallest valid packed value.
+  double valid_min = 0.0;
+  /// Whether the variable has an upper bound for valid values.
+  bool has_valid_max = false;
+  /// The largest valid packed value.
+  double valid_max = 0.0;
+};
+
+namespace detail {
+
+/** Decode CF-packed values.
+ *
+ * Unpacks values as value * scale_factor + add_offset and replaces fill,
+ * missing and out-of-range values with NaN. The loop is free of branches,
+ * so that it can be vectorized.
+ *
+ * @param source Pointer to the packed values.
+ * @param destination Pointer to the output array, which must not overlap
+ *     with the packed values.
+ * @param n The number of values to decode.
+ * @param packing The packing parameters of the variable.
+ */
+template <typename Source, typename Destination>
+inline void decode_cf(const Source* __restrict__ source,
+                      Destination* __restrict__ destination,
+                      size_t n,
+                      const CFPacking& packing) {
+  const Destination nan = std::numeric_limits<Destination>::quiet_NaN();
+  const Destination scale_factor = static_cast<Destination>(packing.scale_factor);
+  const Destination add_offset = static_cast<Destination>(packing.add_offset);
+  // Absent checks are disabled through the flags rather than through NaN
+  // or infinite sentinels, which -ffinite-math-only may fold away.
+  const bool has_fill_value = packing.has_fill_value;
+  const bool has_missing_value = packing.has_missing_value;
+  const bool has_valid_min = packing.has_valid_min;
+  const bool has_valid_max = packing.has_valid_max;
+  const Destination fill_value =
+      has_fill_value ? static_cast<Destination>(packing.fill_value) : Destination(0);
+  const Destination missing_value =
+      has_missing_value ? static_cast<Destination>(packing.missing_value) : Destination(0);
+  const Destination valid_min =
+      has_valid_min ? static_cast<Destination>(packing.valid_min) : Destination(0);
+  const Destination valid_max =
+      has_valid_max ? static_cast<Destination>(packing.valid_max) : Destination(0);
+  for (size_t i = 0; i < n; ++i) {
+    Destination value = static_cast<Destination>(source[i]);
+    bool invalid = (has_fill_value & (value == fill_value)) |
+                   (has_missing_value & (value == missing_value)) |
+                   (has_valid_min & (value < valid_min)) |
+                   (has_valid_max & (value > valid_max));
+    destination[i] = invalid ? nan : value * scale_factor + add_offset;
+  }
+}
+
+}  // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// Storage options
+////////////////////////////////////////////////////////////////////////////////
+/// Expected access pattern of a variable, from which its chunk shape
+/// is chosen if no chunk sizes are given.
+enum class AccessPattern {
+  /// Balanced chunks for variables that have unlimited dimensions or
+  /// chunked layout, the NetCDF-c defaults otherwise.
+  Auto,
+  /// Leave the choice of the chunk shape to the NetCDF-c library.
+  Library,
+  /// Data is accessed one record, i.e. one index along the record
+  /// dimension, at a time.
+  Records,
+  /// Data is accessed as time series, i.e. along the record dimension
+  /// for small regions of the remaining dimensions.
+  TimeSeries,
+  /// No preferred direction of access.
+  Balanced
+};
+
+inline std::ostream& operator<<(std::ostream& out, AccessPattern pattern) {
+  switch (pattern) {
+    case AccessPattern::Auto: out << "auto"; break;
+    case AccessPattern::Library: out << "library"; break;
+    case AccessPattern::Records: out << "records"; break;
+    case AccessPattern::TimeSeries: out << "time series"; break;
+    case AccessPattern::Balanced: out << "balanced"; break;
+  }
+  return out;
+}
+
+/** Storage options of a variable.
+ *
+ * Describes how the data of a variable is laid out in the file and
+ * which filters are applied to it. Unless chunk sizes are given, the
+ * chunk shape of variables with unlimited dimensions is chosen from the
+ * access pattern and the target chunk size. All other choices are left
+ * to the NetCDF-c library by default.
+ */
+struct StorageOptions {
+  /// The storage layout of the variable.
+  Layout layout = Layout::Default;
+  /// Chunk sizes along each dimension of the variable. Setting chunk sizes
+  /// implies chunked layout.
+  std::vector<size_t> chunk_sizes = {};
+  /// Expected access pattern used to choose chunk sizes if none are given.
+  AccessPattern access_pattern = AccessPattern::Auto;
+  /// Target size in bytes of chunks chosen from the access pattern.
+  size_t chunk_bytes = size_t(1) << 20;
+  /// Deflate level between 0 and 9. A level of 0 disables compression.
+  int deflate_level = 0;
+  /// Whether to apply the shuffle filter before compression.
+  bool shuffle = false;
+  /// Whether to store Fletcher32 checksums of the data.
+  bool fletcher32 = false;
+  /// Whether to prefill the variable. Defaults to the fill mode of the file.
+  FillMode fill_mode = FillMode::Default;
+};
+
+/** Chunk shape chosen for a variable. */
+struct ChunkPlan {
+  /// The access pattern the chunk shape was chosen for.
+  AccessPattern access_pattern = AccessPattern::Library;
+  /// The chunk sizes. Empty if the variable isn't chunked or the chunk
+  /// shape is chosen by the NetCDF-c library.
+  std::vector<size_t> chunk_sizes = {};
+  /// The size of a chunk in bytes. Zero if chunk_sizes is empty.
+  size_t chunk_bytes = 0;
+  /// Explanation of the choice.
+  std::string description = "";
+};
+
+namespace detail {
+
+// Chooses chunk shape for access pattern by halving the largest chunk
+// extents until the chunk holds at most n_target elements. Unlimited
+// dimensions are treated as if they held n_target elements.
+inline std::vector<size_t> chunk_shape(const std::vector<size_t>& shape,
+                                       const std::vector<bool>& unlimited,
+                                       size_t n_target,
+                                       AccessPattern pattern) {
+  size_t rank = shape.size();
+  size_t record_axis = 0;
+  for (size_t i = 0; i < rank; ++i) {
+    if (unlimited[i]) {
+      record_axis = i;
+      break;
+    }
+  }
+
+  std::vector<size_t> extents(rank);
+  std::vector<bool> frozen(rank, false);
+  for (size_t i = 0; i < rank; ++i) {
+    extents[i] = unlimited[i] ? n_target : std::max<size_t>(shape[i], 1);
+    if (pattern != AccessPattern::Balanced && unlimited[i] && i != record_axis) {
+      extents[i] = 1;
+    }
+  }
+  if (pattern == AccessPattern::Records) {
+    extents[record_axis] = 1;
+  } else if (pattern == AccessPattern::TimeSeries) {
+    size_t reserved = static_cast<size_t>(std::ceil(std::sqrt(n_target)));
+    extents[record_axis] = std::min(extents[record_axis], reserved);
+  }
+  if (pattern != AccessPattern::Balanced) {
+    frozen[record_axis] = true;
+  }
+
+  auto product = [&extents]() {
+    double result = 1.0;
+    for (auto e : extents) {
+      result *= static_cast<double>(e);
+    }
+    return result;
+  };
+  while (product() > static_cast<double>(n_target)) {
+    size_t largest = rank;
+    for (size_t i = 0; i < rank; ++i) {
+      if (!frozen[i] && extents[i] > 1 &&
+          (largest == rank || extents[i] > extents[largest])) {
+        largest = i;
+      }
+    }
+    if (largest == rank) {
+      break;
+    }
+    extents[largest] = (extents[largest] + 1) / 2;
+  }
+
+  // Time series chunks extend along the record axis as far as the
+  // remaining dimensions allow.
+  if (pattern == AccessPattern::TimeSeries) {
+    extents[record_axis] = 1;
+    size_t length = static_cast<size_t>(
+        std::max(static_cast<double>(n_target) / product(), 1.0));
+    if (!unlimited[record_axis]) {
+      length = std::min(length, std::max<size_t>(shape[record_axis], 1));
+    }
+    extents[record_axis] = length;
+  }
+  return extents;
+}
+
+}  // namespace detail
+
+/** Choose chunk shape for a variable.
+ *
+ * Chunk sizes given in the storage options are used as they are.
+ * Otherwise, the chunk shape is chosen from the access pattern such that
+ * chunks hold about storage.chunk_bytes bytes:
+ *
+ *   - Records: One index along the record dimension, i.e. the first
+ *     unlimited or, if there is none, the first dimension. The remaining
+ *     dimensions are covered as far as possible.
+ *   - TimeSeries: The remaining dimensions are reduced until they hold
+ *     at most the square root of the targeted number of elements. The
+ *     record dimension then takes the rest.
+ *   - Balanced: The largest extents are halved until the chunk fits the
+ *     target size, which leads to chunks of similar extent along all
+ *     dimensions that are not smaller than that.
+ *
+ * Note that chunks at the end of an unlimited dimension are allocated in
+ * full, so small files with long chunks along unlimited dimensions waste
+ * space unless compression is applied.
+ *
+ * @param shape The size of each dimension of the variable. Sizes of
+ *     unlimited dimensions are ignored.
+ * @param unlimited Whether each dimension is unlimited.
+ * @param element_size The size of the variable's elements in bytes.
+ * @param storage The storage options of the variable.
+ * @return The chosen chunk shape.
+ */
+inline ChunkPlan plan_chunks(const std::vector<size_t>& shape,
+                             const std::vector<bool>& unlimited,
+                             size_t element_size,
+                             const StorageOptions& storage) {
+  ChunkPlan plan{};
+  plan.access_pattern = storage.access_pattern;
+  bool has_unlimited =
+      std::find(unlimited.begin(), unlimited.end(), true) != unlimited.end();
+  std::stringstream description;
+  if (!storage.chunk_sizes.empty()) {
+    plan.chunk_sizes = storage.chunk_sizes;
+    description << "Chunk sizes set explicitly.";
+  } else if (shape.empty() || storage.layout == Layout::Contiguous ||
+             storage.layout == Layout::Compact) {
+    plan.access_pattern = AccessPattern::Library;
+    description << "Variable is not chunked.";
+  } else {
+    if (plan.access_pattern == AccessPattern::Auto) {
+      plan.access_pattern = (has_unlimited || storage.layout == Layout::Chunked)
+                                ? AccessPattern::Balanced
+                                : AccessPattern::Library;
+    }
+    if (plan.access_pattern == AccessPattern::Library) {
+      description << "Chunk sizes chosen by the NetCDF-c library.";
+    } else {
+      size_t n_target = std::max<size_t>(storage.chunk_bytes / element_size, 1);
+      plan.chunk_sizes =
+          detail::chunk_shape(shape, unlimited, n_target, plan.access_pattern);
+      description << "Chunks for " << plan.access_pattern << " access with a "
+                  << "target size of " << storage.chunk_bytes << " bytes.";
+    }
+  }
+  if (!plan.chunk_sizes.empty()) {
+    plan.chunk_bytes = element_size;
+    for (auto extent : plan.chunk_sizes) {
+      plan.chunk_bytes *= extent;
+    }
+  }
+  plan.description = description.str();
+  return plan;
+}
+
+namespace detail {
+
+// Whether dimension is an unlimited dimension of the given group or
+// one of its ancestors.
+inline bool is_unlimited(FileID& file, int group_id, int dim_id) {
+  while (true) {
+    int n_dims = 0;
+    int error = file.instrument(CallCategory::Inquire, [&] {
+      return nc_inq_unlimdims(group_id, &n_dims, 0);
+    });
+    handle_error("Error inquiring unlimited dimensions:", error);
+    std::vector<int> dim_ids(n_dims);
+    error = file.instrument(CallCategory::Inquire, [&] {
+      return nc_inq_unlimdims(group_id, 0, dim_ids.data());
+    });
+    handle_error("Error inquiring unlimited dimensions:", error);
+    if (std::find(dim_ids.begin(), dim_ids.end(), dim_id) != dim_ids.end()) {
+      return true;
+    }
+    error = file.instrument(CallCategory::Inquire, [&] {
+      return nc_inq_grp_parent(group_id, &group_id);
+    });
+    if (error != NC_NOERR) {
+      return false;
+    }
+  }
+}
+
+// Chooses the chunk shape of a newly defined variable.
+inline ChunkPlan plan_variable_chunks(FileID& file,
+                                      int group_id,
+                                      int var_id,
+                                      const StorageOptions& storage) {
+  int n_dims = 0, type = 0;
+  int error = file.instrument(CallCategory::Inquire, [&] {
+    return nc_inq_var(group_id, var_id, nullptr, &type, &n_dims, nullptr, nullptr);
+  }, group_id, var_id);
+  handle_error("Error inquiring variable:", error);
+  std::vector<int> dim_ids(n_dims);
+  error = file.instrument(CallCategory::Inquire, [&] {
+    return nc_inq_vardimid(group_id, var_id, dim_ids.data());
+  }, group_id, var_id);
+  handle_error("Error inquiring dimension IDs of variable:", error);
+  std::vector<size_t> shape(n_dims);
+  std::vector<bool> unlimited(n_dims);
+  for (int i = 0; i < n_dims; ++i) {
+    error = file.instrument(CallCategory::Inquire, [&] {
+      return nc_inq_dimlen(group_id, dim_ids[i], &shape[i]);
+    });
+    handle_error("Error inquiring dimension length:", error);
+    unlimited[i] = is_unlimited(file, group_id, dim_ids[i]);
+  }
+  size_t element_size = 0;
+  error = file.instrument(CallCategory::Inquire, [&] {
+    return nc_inq_type(group_id, type, nullptr, &element_size);
+  });
+  handle_error("Error inquiring type size:", error);
+  return plan_chunks(shape, unlimited, element_size, storage);
+}
+
+/** Apply storage options to variable.
+ *
+ * Must be called in define mode, before any data has been written
+ * to the variable.
+ *
+ * @param file The file containing the variable.
+ * @param group_id ID of the group containing the variable.
+ * @param var_id ID of the variable.
+ * @param storage The storage options to apply.
+ */
+inline void define_storage(FileID& file,
+                           int group_id,
+                           int var_id,
+                           const StorageOptions& storage) {
+  Layout layout = storage.layout;
+  std::vector<size_t> planned_sizes = {};
+  if ((layout == Layout::Default || layout == Layout::Chunked) &&
+      storage.chunk_sizes.empty() &&
+      storage.access_pattern != AccessPattern::Library) {
+    planned_sizes = plan_variable_chunks(file, group_id, var_id, storage).chunk_sizes;
+  }
+  const std::vector<size_t>& sizes =
+      storage.chunk_sizes.empty() ? planned_sizes : storage.chunk_sizes;
+  if (layout == Layout::Default && sizes.size() > 0) {
+    layout = Layout::Chunked;
+  }
+  if (layout != Layout::Default) {
+    const size_t* chunk_sizes = nullptr;
+    if (sizes.size() > 0) {
+      chunk_sizes = sizes.data();
+    }
+    int error = file.instrument(CallCategory::Define, [&] {
+      return nc_def_var_chunking(group_id,
+                                 var_id,
+                                 static_cast<int>(layout),
+                                 chunk_sizes);
+    }, group_id, var_id);
+    handle_error("Error defining variable storage layout:", error);
+  }
+  if (storage.deflate_level > 0 || storage.shuffle) {
+    int error = file.instrument(CallCategory::Define, [&] {
+      return nc_def_var_deflate(group_id,
+                                var_id,
+                                storage.shuffle ? NC_SHUFFLE : NC_NOSHUFFLE,
+                                storage.deflate_level > 0,
+                                storage.deflate_level);
+    }, group_id, var_id);
+    handle_error("Error defining variable compression:", error);
+  }
+  if (storage.fletcher32) {
+    int error = file.instrument(CallCategory::Define, [&] {
+      return nc_def_var_fletcher32(group_id, var_id, NC_FLETCHER32);
+    }, group_id, var_id);
+    handle_error("Error defining variable checksum:", error);
+  }
+  if (storage.fill_mode != FillMode::Default) {
+    int error = file.instrument(CallCategory::Define, [&] {
+      return nc_def_var_fill(
+          group_id, var_id, storage.fill_mode == FillMode::NoFill, nullptr);
+    }, group_id, var_id);
+    handle_error("Error defining variable fill mode:", error);
+  }
+}
+
+}  // namespace detail
+
+/** Chunk cache settings.
+ *
+ * Settings of the HDF5 chunk cache that holds decompressed chunks of
+ * chunked variables.
+ */
+struct ChunkCache {
+  /// Size of the cache in bytes.
+  size_t size = 0;
+  /// Number of chunk slots in the cache.
+  size_t n_elements = 0;
+  /// Preemption of fully read or written chunks, between 0 and 1.
+  float preemption = 0.75;
+};
+
+/// Whether a variable's chunk cache is adapted automatically to the
+/// hyperslabs that are read from it.
+enum class ChunkCachePolicy {
+  /// Keep the chunk cache settings as they are.
+  Manual,
+  /// Grow the chunk cache to hold all chunks touched by a hyperslab read.
+  Auto
 };
 
+namespace detail {
+
+// Smallest prime number larger than or equal to n.
+inline size_t next_prime(size_t n) {
+  if (n <= 2) {
+    return 2;
+  }
+  if (n % 2 == 0) {
+    ++n;
+  }
+  while (true) {
+    bool prime = true;
+    for (size_t d = 3; d * d <= n; d += 2) {
+      if (n % d == 0) {
+        prime = false;
+        break;
+      }
+    }
+    if (prime) {
+      return n;
+    }
+    n += 2;
+  }
+}
+
+}  // namespace detail
+
 ////////////////////////////////////////////////////////////////////////////////
 // NetCDF Dimension
 ////////////////////////////////////////////////////////////////////////////////
@@ -280,85 +1847,1835 @@ struct Dimension {
 };
 
 ////////////////////////////////////////////////////////////////////////////////
-// NetCDF Variable
+// NetCDF Attribute
 ////////////////////////////////////////////////////////////////////////////////
-/** NetCDF variable
- *
- * Represents a variable in a NetCDF File.
+/** NetCDF attribute
  *
+ * Represents an attribute of a group or variable together with its values.
+ * Numeric and text values are stored in their NetCDF representation and
+ * converted to the requested C++ type on access.
  */
-class Variable {
-
- private:
-
-  // Parses dimensions of this variable.
-  void parse_dimensions() {
-    int n_dims = dimensions_.capacity();
-    auto dim_ids = std::make_unique<int[]>(n_dims);
-    int error = nc_inq_vardimid(parent_id_, id_, dim_ids.get());
-    detail::handle_error("Error inquiring dimension IDs of variable:", error);
+class Attribute {
+ public:
+  Attribute() {}
 
-    for (int i = 0; i < n_dims; ++i) {
-      int dim_id = dim_ids[i];
-      Dimension dim{dim_id};
-      error = nc_inq_dim(parent_id_, dim_id, dim.name, &dim.size);
-      detail::handle_error("Error inquiring dimension:", error);
-      dimensions_.push_back(dim);
+  /** Read attribute from file.
+   *
+   * @param file The file containing the attribute.
+   * @param parent_id ID of the group containing the attribute.
+   * @param var_id ID of the variable the attribute belongs to, or NC_GLOBAL
+   *     for group attributes.
+   * @param name The name of the attribute.
+   */
+  Attribute(detail::FileID& file, int parent_id, int var_id, std::string name)
+      : name_(name) {
+    int type = 0;
+    int error = file.instrument(CallCategory::Inquire, [&] {
+      return nc_inq_att(parent_id, var_id, name_.c_str(), &type, &length_);
+    }, parent_id, var_id);
+    detail::handle_error("Error inquiring attribute " + name_ + ":", error);
+    type_ = Type(type);
+    if (type_ == Type::String) {
+      std::vector<char*> strings(length_);
+      error = file.instrument(CallCategory::Inquire, [&] {
+        return nc_get_att_string(parent_id, var_id, name_.c_str(), strings.data());
+      }, parent_id, var_id);
+      detail::handle_error("Error reading attribute " + name_ + ":", error);
+      strings_.reserve(length_);
+      for (auto& string : strings) {
+        strings_.push_back(string ? string : "");
+      }
+      error = nc_free_string(strings.size(), strings.data());
+      detail::handle_error("Error freeing strings:", error);
+    } else {
+      size_t type_size = 0;
+      error = file.instrument(CallCategory::Inquire, [&] {
+        return nc_inq_type(parent_id, type, 0, &type_size);
+      }, parent_id, var_id);
+      detail::handle_error("Error inquiring attribute type:", error);
+      data_.resize(length_ * type_size);
+      error = file.instrument(CallCategory::Inquire, [&] {
+        return nc_get_att(parent_id, var_id, name_.c_str(), data_.data());
+      }, parent_id, var_id);
+      detail::handle_error("Error reading attribute " + name_ + ":", error);
     }
   }
 
-  // Checks that NetCDF type is compatible with provided C++ type.
+  /** Create attribute from values.
+   *
+   * @param name The name of the attribute.
+   * @param values The values of the attribute.
+   */
   template <typename T>
-  void check_type() {
-      if (TypeProperties<T>::value != type_) {
-          std::stringstream msg;
-          msg << "Provided type " << TypeProperties<T>::value << " is incompatible "
-              << "with NetCDF type " << type_ << std::endl;
-          throw std::runtime_error(msg.str());
-      }
+  Attribute(std::string name, const std::vector<T>& values)
+      : name_(name), type_(TypeProperties<T>::value), length_(values.size()) {
+    static_assert(std::is_arithmetic_v<T>,
+                  "Attribute values must be of arithmetic type.");
+    data_.resize(values.size() * sizeof(T));
+    std::memcpy(data_.data(), values.data(), data_.size());
   }
 
-public:
-
-  Variable() {}
+  /** Create text attribute.
+   *
+   * @param name The name of the attribute.
+   * @param text The text of the attribute.
+   */
+  Attribute(std::string name, std::string text)
+      : name_(name), type_(Type::Char), length_(text.size()), data_(text.begin(), text.end()) {}
 
-  /** Create variable.
+  /** Create string attribute.
    *
-   * This creates a variable and parses its dimensions and attributes.
+   * @param name The name of the attribute.
+   * @param strings The strings of the attribute.
+   */
+  Attribute(std::string name, const std::vector<std::string>& strings)
+      : name_(name), type_(Type::String), length_(strings.size()), strings_(strings) {}
+
+  /** Write attribute to file.
    *
-   * @param file_ptr Shared pointer to file object to which this variable belongs.
-   * @param parent_id NetCDF ID of the parent group of this variable.
-   * @param id The variabl ID that identifies this variable in the NetCDF-c library.
+   * @param file The file to write the attribute to.
+   * @param parent_id ID of the group containing the attribute.
+   * @param var_id ID of the variable the attribute belongs to, or NC_GLOBAL
+   *     for group attributes.
    */
-  Variable(std::shared_ptr<detail::FileID> file_ptr, int parent_id, int id)
-      : id_(id), parent_id_(parent_id), file_ptr_(file_ptr) {
-    int n_dims, n_attrs, type;
-    int error = nc_inq_var(parent_id_, id_, name_, &type, &n_dims, 0, &n_attrs);
-    detail::handle_error("Error inquiring variable:", error);
-    type_ = Type(type);
-    dimensions_.reserve(n_dims);
-    parse_dimensions();
+  void write(detail::FileID& file, int parent_id, int var_id) const {
+    int error = NC_NOERR;
+    if (type_ == Type::String) {
+      std::vector<const char*> strings;
+      strings.reserve(strings_.size());
+      for (auto& string : strings_) {
+        strings.push_back(string.c_str());
+      }
+      error = file.instrument(CallCategory::Define, [&] {
+        return nc_put_att_string(
+            parent_id, var_id, name_.c_str(), strings.size(), strings.data());
+      }, parent_id, var_id);
+    } else {
+      error = file.instrument(CallCategory::Define, [&] {
+        return nc_put_att(parent_id,
+                          var_id,
+                          name_.c_str(),
+                          static_cast<int>(type_),
+                          length_,
+                          data_.data());
+      }, parent_id, var_id);
+    }
+    detail::handle_error("Error writing attribute " + name_ + ":", error);
   }
 
-  /** Write data to variable.
-     *
-     * @tparam T The datatype to write to the variable.
-     * @param data Start pointer to the destination of the read operation.
-     */
+  /// The name of the attribute.
+  std::string get_name() const { return name_; }
+
+  /// The NetCDF type of the attribute.
+  Type get_type() const { return type_; }
+
+  /// The number of values of the attribute.
+  size_t size() const { return length_; }
+
+  /** Values of the attribute.
+   *
+   * @tparam T The arithmetic type to convert the values to.
+   * @return Vector containing the values of the attribute.
+   */
   template <typename T>
-  void write(T* data) {
-    using TypeTraits = TypeProperties<T>;
-    check_type<T>();
-    detail::assert_write_mode(*file_ptr_);
-    TypeTraits::write(parent_id_, id_, data);
+  std::vector<T> get_values() const {
+    static_assert(std::is_arithmetic_v<T>,
+                  "Attribute values must be of arithmetic type.");
+    std::vector<T> values(length_);
+    dispatch(type_, [&](auto tag) {
+      using S = typename decltype(tag)::type;
+      if constexpr (std::is_arithmetic_v<S> && !std::is_same_v<S, char>) {
+        std::vector<S> source(length_);
+        std::memcpy(source.data(), data_.data(), length_ * sizeof(S));
+        detail::convert(source.data(), values.data(), length_);
+      } else {
+        std::stringstream msg;
+        msg << "Attribute " << name_ << " of type " << type_
+            << " is not numeric.";
+        throw std::runtime_error(msg.str());
+      }
+    });
+    return values;
   }
 
-  /** Write data to variable.
+  /** First value of the attribute.
    *
-   * Write data to hyperslab of variable memory.
+   * @tparam T The arithmetic type to convert the value to.
+   * @return The first value of the attribute.
+   */
+  template <typename T>
+  T get_value() const {
+    auto values = get_values<T>();
+    if (values.empty()) {
+      throw std::runtime_error("Attribute " + name_ + " has no values.");
+    }
+    return values[0];
+  }
+
+  /** Text of the attribute.
    *
-   * @tparam T The datatype to write to the variable.
-   * @tparam N_DIM The number of dimensions of the variable.
+   * @return The text of a text attribute or the first string of a string
+   *     attribute.
+   */
+  std::string get_text() const {
+    if (type_ == Type::Char) {
+      return std::string(data_.begin(), data_.end());
+    }
+    if (type_ == Type::String && !strings_.empty()) {
+      return strings_[0];
+    }
+    throw std::runtime_error("Attribute " + name_ + " is not a text attribute.");
+  }
+
+  /// The strings of a string attribute.
+  const std::vector<std::string>& get_strings() const { return strings_; }
+
+ private:
+  std::string name_ = "";
+  Type type_ = Type::NotAType;
+  size_t length_ = 0;
+  std::vector<char> data_ = {};
+  std::vector<std::string> strings_ = {};
+};
+
+namespace detail {
+
+/** Lazily parsed attributes of a group or variable.
+ *
+ * The attributes are read from the file on first access and cached
+ * afterwards. The cache is shared between copies of the group or variable
+ * object it belongs to.
+ */
+class Attributes {
+  struct Cache {
+    bool parsed = false;
+    size_t version = 0;
+    std::map<std::string, Attribute> attributes = {};
+  };
+
+  // Reads all attributes into the cache.
+  void parse() const {
+    if (cache_->parsed) {
+      return;
+    }
+    int n_attrs = 0;
+    int error = file_->instrument(CallCategory::Inquire, [&] {
+      if (var_id_ == NC_GLOBAL) {
+        return nc_inq_natts(parent_id_, &n_attrs);
+      }
+      return nc_inq_varnatts(parent_id_, var_id_, &n_attrs);
+    }, parent_id_, var_id_);
+    handle_error("Error inquiring number of attributes:", error);
+    char name[NC_MAX_NAME + 1] = {0};
+    for (int i = 0; i < n_attrs; ++i) {
+      error = file_->instrument(CallCategory::Inquire, [&] {
+        return nc_inq_attname(parent_id_, var_id_, i, name);
+      }, parent_id_, var_id_);
+      handle_error("Error inquiring attribute name:", error);
+      cache_->attributes[name] = Attribute(*file_, parent_id_, var_id_, name);
+    }
+    cache_->parsed = true;
+  }
+
+ public:
+  Attributes() {}
+
+  /** Create attribute cache.
+   *
+   * @param file The file containing the attributes. Must outlive the cache.
+   * @param parent_id ID of the group containing the attributes.
+   * @param var_id ID of the variable the attributes belong to, or NC_GLOBAL
+   *     for group attributes.
+   */
+  Attributes(FileID& file, int parent_id, int var_id)
+      : file_(&file),
+        parent_id_(parent_id),
+        var_id_(var_id),
+        cache_(std::make_shared<Cache>()) {}
+
+  /// Whether an attribute of the given name exists.
+  bool has(const std::string& name) const {
+    parse();
+    return cache_->attributes.find(name) != cache_->attributes.end();
+  }
+
+  /// Retrieve attribute by name.
+  const Attribute& get(const std::string& name) const {
+    parse();
+    auto found = cache_->attributes.find(name);
+    if (found != cache_->attributes.end()) {
+      return found->second;
+    }
+    throw std::runtime_error("Attribute " + name + " not found in attributes.");
+  }
+
+  /// Names of all attributes.
+  std::vector<std::string> names() const {
+    parse();
+    std::vector<std::string> names;
+    names.reserve(cache_->attributes.size());
+    for (auto& pair : cache_->attributes) {
+      names.push_back(pair.first);
+    }
+    return names;
+  }
+
+  /** Write attribute to file and cache.
+   *
+   * Must be called in define mode.
+   *
+   * @param attribute The attribute to write.
+   */
+  void set(const Attribute& attribute) {
+    parse();
+    attribute.write(*file_, parent_id_, var_id_);
+    cache_->attributes[attribute.get_name()] = attribute;
+    ++cache_->version;
+  }
+
+  /// Discard cached attributes so that they are re-read on next access.
+  void reset() {
+    cache_->parsed = false;
+    cache_->attributes.clear();
+    ++cache_->version;
+  }
+
+  /// Counter that is incremented whenever the attributes change.
+  size_t version() const { return cache_->version; }
+
+ private:
+  FileID* file_ = nullptr;
+  int parent_id_ = 0;
+  int var_id_ = NC_GLOBAL;
+  std::shared_ptr<Cache> cache_ = nullptr;
+};
+
+}  // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+// Memory-mapped data
+////////////////////////////////////////////////////////////////////////////////
+#ifdef NETCDFHPP_HAS_MMAP
+/** Read-only memory mapping of a file.
+ *
+ * Maps a file into memory once, so that it can be opened repeatedly
+ * with File::open_memory without reading it from disk.
+ */
+class MappedFile {
+ public:
+  /** Map file into memory.
+   *
+   * @param path The path of the file to map.
+   * @return Shared pointer to the mapping.
+   * @throw std::runtime_error if the file can't be mapped.
+   */
+  static std::shared_ptr<const MappedFile> map(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Could not open file " + path + " for mapping.");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+      ::close(fd);
+      throw std::runtime_error("Could not map file " + path + ".");
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      throw std::runtime_error("Could not map file " + path + ".");
+    }
+    return std::shared_ptr<const MappedFile>(new MappedFile(data, size));
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile() { munmap(data_, size_); }
+
+  /// The mapped bytes.
+  std::span<const std::byte> bytes() const {
+    return {static_cast<const std::byte*>(data_), size_};
+  }
+
+ private:
+  MappedFile(void* data, size_t size) : data_(data), size_(size) {}
+
+  void* data_;
+  size_t size_;
+};
+#endif
+
+#if defined(NETCDFHPP_WITH_HDF5) && defined(NETCDFHPP_HAS_MMAP)
+namespace detail {
+
+/** HDF5 dataset of a NetCDF4 variable.
+ *
+ * Opens the HDF5 file underlying a NetCDF4 file read-only to inquire
+ * where the data of a variable is stored. HDF5 errors are suppressed;
+ * whether the dataset was found is indicated by operator bool.
+ */
+class HDF5Dataset {
+ public:
+  /** Open dataset.
+   *
+   * @param path The path of the file.
+   * @param group_name The full name of the variable's group.
+   * @param name The name of the variable.
+   */
+  HDF5Dataset(const std::string& path,
+              const std::string& group_name,
+              const std::string& name) {
+    std::string prefix = group_name.back() == '/' ? group_name : group_name + "/";
+    H5E_BEGIN_TRY {
+      file_id_ = H5Fopen(path.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+      if (file_id_ >= 0) {
+        // Variables that share their name with a dimension they don't
+        // represent are stored under a prefix.
+        for (auto coord_prefix : {"", "_nc4_non_coord_"}) {
+          std::string dataset_name = prefix + coord_prefix + name;
+          dataset_id_ = H5Dopen2(file_id_, dataset_name.c_str(), H5P_DEFAULT);
+          if (dataset_id_ >= 0) {
+            break;
+          }
+        }
+      }
+    } H5E_END_TRY;
+  }
+
+  HDF5Dataset(const HDF5Dataset&) = delete;
+  HDF5Dataset& operator=(const HDF5Dataset&) = delete;
+
+  ~HDF5Dataset() {
+    H5E_BEGIN_TRY {
+      if (dataset_id_ >= 0) {
+        H5Dclose(dataset_id_);
+      }
+      if (file_id_ >= 0) {
+        H5Fclose(file_id_);
+      }
+    } H5E_END_TRY;
+  }
+
+  explicit operator bool() const { return dataset_id_ >= 0; }
+  hid_t id() const { return dataset_id_; }
+
+ private:
+  hid_t file_id_ = H5I_INVALID_HID;
+  hid_t dataset_id_ = H5I_INVALID_HID;
+};
+
+/// Location of a chunk of a dataset in the file.
+struct ChunkLocation {
+  std::vector<hsize_t> offset;
+  unsigned filter_mask;
+  haddr_t address;
+  hsize_t size;
+};
+
+// Locations of all chunks of a dataset with the given shape and chunk
+// shape. Chunks that haven't been allocated have an undefined address.
+inline std::vector<ChunkLocation> get_chunk_locations(hid_t dataset_id,
+                                                      const std::vector<size_t>& shape,
+                                                      const std::vector<hsize_t>& chunk_shape) {
+  size_t rank = shape.size();
+  std::vector<ChunkLocation> chunks;
+#if H5_VERSION_GE(1, 14, 0)
+  struct Iteration {
+    std::vector<ChunkLocation>* chunks;
+    size_t rank;
+  } iteration{&chunks, rank};
+  auto callback = [](const hsize_t* offset,
+                     unsigned filter_mask,
+                     haddr_t address,
+                     hsize_t size,
+                     void* data) -> int {
+    auto iteration = static_cast<Iteration*>(data);
+    iteration->chunks->push_back(
+        {std::vector<hsize_t>(offset, offset + iteration->rank), filter_mask, address, size});
+    return H5_ITER_CONT;
+  };
+  if (H5Dchunk_iter(dataset_id, H5P_DEFAULT, callback, &iteration) < 0) {
+    chunks.clear();
+  }
+#else
+  // Look up chunks by their coordinates, which, unlike lookups by index,
+  // doesn't require a scan of the chunk index per chunk.
+  std::vector<hsize_t> offset(rank, 0);
+  while (true) {
+    ChunkLocation chunk{offset, 0, HADDR_UNDEF, 0};
+    if (H5Dget_chunk_info_by_coord(dataset_id,
+                                   offset.data(),
+                                   &chunk.filter_mask,
+                                   &chunk.address,
+                                   &chunk.size) < 0) {
+      return {};
+    }
+    chunks.push_back(std::move(chunk));
+    size_t dim = rank;
+    while (dim > 0) {
+      --dim;
+      offset[dim] += chunk_shape[dim];
+      if (offset[dim] < shape[dim]) {
+        break;
+      }
+      offset[dim] = 0;
+      if (dim == 0) {
+        return chunks;
+      }
+    }
+  }
+#endif
+  return chunks;
+}
+
+// Reverses the filters of a chunk, which were applied in pipeline
+// order. Set bits in filter_mask mark filters that were skipped. Only
+// deflate and shuffle are supported. Returns a pointer to the decoded
+// chunk, which is held in one of the buffers, or nullptr if the chunk
+// couldn't be decoded.
+inline const std::byte* decode_chunk(std::span<const std::byte> raw,
+                                     const std::vector<H5Z_filter_t>& filters,
+                                     unsigned filter_mask,
+                                     size_t element_size,
+                                     std::vector<std::byte>& buffer_1,
+                                     std::vector<std::byte>& buffer_2) {
+  size_t chunk_bytes = buffer_1.size();
+  const std::byte* input = raw.data();
+  size_t input_size = raw.size();
+  std::vector<std::byte>* output = &buffer_1;
+  for (size_t i = filters.size(); i > 0; --i) {
+    if (filter_mask & (1u << (i - 1))) {
+      continue;
+    }
+    if (filters[i - 1] == H5Z_FILTER_DEFLATE) {
+      uLongf size = chunk_bytes;
+      int status = uncompress(reinterpret_cast<Bytef*>(output->data()),
+                              &size,
+                              reinterpret_cast<const Bytef*>(input),
+                              static_cast<uLong>(input_size));
+      if (status != Z_OK || size != chunk_bytes) {
+        return nullptr;
+      }
+    } else {
+      if (input_size != chunk_bytes) {
+        return nullptr;
+      }
+      size_t n = chunk_bytes / element_size;
+      for (size_t byte = 0; byte < element_size; ++byte) {
+        const std::byte* plane = input + byte * n;
+        for (size_t j = 0; j < n; ++j) {
+          (*output)[j * element_size + byte] = plane[j];
+        }
+      }
+    }
+    input = output->data();
+    input_size = chunk_bytes;
+    output = output == &buffer_1 ? &buffer_2 : &buffer_1;
+  }
+  return input_size == chunk_bytes ? input : nullptr;
+}
+
+// Copies the part of a decoded chunk that lies within the dataset to
+// the row-major destination array.
+inline void scatter_chunk(const std::byte* chunk,
+                          const std::vector<hsize_t>& offset,
+                          const std::vector<hsize_t>& chunk_shape,
+                          const std::vector<size_t>& shape,
+                          size_t element_size,
+                          std::byte* data) {
+  size_t rank = shape.size();
+  std::vector<size_t> extents(rank);
+  for (size_t i = 0; i < rank; ++i) {
+    extents[i] = std::min<size_t>(chunk_shape[i], shape[i] - offset[i]);
+  }
+  size_t row_bytes = extents[rank - 1] * element_size;
+  std::vector<size_t> index(rank, 0);
+  while (true) {
+    size_t source = 0;
+    size_t destination = 0;
+    for (size_t i = 0; i < rank; ++i) {
+      source = source * chunk_shape[i] + index[i];
+      destination = destination * shape[i] + offset[i] + index[i];
+    }
+    std::memcpy(data + destination * element_size, chunk + source * element_size, row_bytes);
+    // Advance to next row of the chunk.
+    size_t dim = rank - 1;
+    while (dim > 0) {
+      --dim;
+      if (++index[dim] < extents[dim]) {
+        break;
+      }
+      index[dim] = 0;
+      if (dim == 0) {
+        return;
+      }
+    }
+    if (rank == 1) {
+      return;
+    }
+  }
+}
+
+/// Chunk layout, filters and chunk locations of a chunked dataset.
+struct ChunkIndex {
+  std::vector<size_t> shape;
+  std::vector<hsize_t> chunk_shape;
+  std::vector<H5Z_filter_t> filters;
+  std::vector<ChunkLocation> chunks;
+  size_t chunk_elements;
+};
+
+/** Index chunks of dataset.
+ *
+ * Inquires the chunk shape and filters of the dataset and the locations
+ * of all its chunks.
+ *
+ * @param dataset_id The dataset to index.
+ * @param shape The shape of the dataset.
+ * @param file_size The size of the file in bytes.
+ * @return The chunk index or nullptr if the dataset uses unsupported
+ *     filters or has chunks that haven't been allocated.
+ */
+inline std::shared_ptr<const ChunkIndex> index_chunks(hid_t dataset_id,
+                                                      const std::vector<size_t>& shape,
+                                                      size_t file_size) {
+  auto index = std::make_shared<ChunkIndex>();
+  size_t rank = shape.size();
+  index->shape = shape;
+  index->chunk_shape.resize(rank);
+  bool supported = false;
+  H5E_BEGIN_TRY {
+    hid_t plist_id = H5Dget_create_plist(dataset_id);
+    if (plist_id >= 0) {
+      supported = H5Pget_layout(plist_id) == H5D_CHUNKED &&
+                  H5Pget_chunk(plist_id, static_cast<int>(rank), index->chunk_shape.data()) ==
+                      static_cast<int>(rank);
+      int n_filters = supported ? H5Pget_nfilters(plist_id) : 0;
+      for (int i = 0; i < n_filters; ++i) {
+        unsigned flags = 0;
+        size_t n_values = 0;
+        H5Z_filter_t filter = H5Pget_filter2(
+            plist_id, static_cast<unsigned>(i), &flags, &n_values, nullptr, 0, nullptr, nullptr);
+        if (filter != H5Z_FILTER_DEFLATE && filter != H5Z_FILTER_SHUFFLE) {
+          supported = false;
+        }
+        index->filters.push_back(filter);
+      }
+      H5Pclose(plist_id);
+    }
+  } H5E_END_TRY;
+  if (!supported) {
+    return nullptr;
+  }
+
+  size_t n_chunks = 1;
+  index->chunk_elements = 1;
+  for (size_t i = 0; i < rank; ++i) {
+    n_chunks *= (shape[i] + index->chunk_shape[i] - 1) / index->chunk_shape[i];
+    index->chunk_elements *= index->chunk_shape[i];
+  }
+  H5E_BEGIN_TRY {
+    index->chunks = get_chunk_locations(dataset_id, shape, index->chunk_shape);
+  } H5E_END_TRY;
+  // Unallocated chunks hold the fill value, which is left to the regular
+  // read path.
+  if (index->chunks.size() != n_chunks) {
+    return nullptr;
+  }
+  for (auto& chunk : index->chunks) {
+    if (chunk.address == HADDR_UNDEF || chunk.address + chunk.size > file_size) {
+      return nullptr;
+    }
+  }
+  return index;
+}
+
+/** Read chunked dataset decompressing chunks in parallel.
+ *
+ * Decompresses the chunks of the dataset and copies them to the
+ * destination on n_threads threads. The compressed data is read from a
+ * memory mapping of the file, so the worker threads don't call into the
+ * HDF5 library.
+ *
+ * @param index The chunk index of the dataset.
+ * @param file_bytes The mapped bytes of the file.
+ * @param element_size The size of the elements in bytes.
+ * @param data The destination of the data in row-major order.
+ * @param n_threads The number of threads to use.
+ * @return false if a chunk couldn't be decoded.
+ */
+inline bool read_chunks_parallel(const ChunkIndex& index,
+                                 std::span<const std::byte> file_bytes,
+                                 size_t element_size,
+                                 std::byte* data,
+                                 size_t n_threads) {
+  const auto& shape = index.shape;
+  const auto& chunk_shape = index.chunk_shape;
+  const auto& filters = index.filters;
+  const auto& chunks = index.chunks;
+  size_t n_chunks = chunks.size();
+  size_t chunk_elements = index.chunk_elements;
+
+  if (n_threads == 0) {
+    n_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  n_threads = std::min(n_threads, n_chunks);
+  std::atomic<size_t> next_chunk = 0;
+  std::atomic<bool> failed = false;
+  auto work = [&] {
+    std::vector<std::byte> buffer_1(chunk_elements * element_size);
+    std::vector<std::byte> buffer_2(chunk_elements * element_size);
+    while (!failed.load(std::memory_order_relaxed)) {
+      size_t position = next_chunk.fetch_add(1, std::memory_order_relaxed);
+      if (position >= n_chunks) {
+        return;
+      }
+      auto& chunk = chunks[position];
+      auto raw = file_bytes.subspan(chunk.address, chunk.size);
+      auto decoded = decode_chunk(
+          raw, filters, chunk.filter_mask, element_size, buffer_1, buffer_2);
+      if (!decoded) {
+        failed = true;
+        return;
+      }
+      scatter_chunk(decoded, chunk.offset, chunk_shape, shape, element_size, data);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < n_threads; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return !failed;
+}
+
+}  // namespace detail
+#endif
+
+/** Read-only view of the data of a variable.
+ *
+ * Holds the data of a variable either as a direct view into a memory
+ * mapping of the file or, where this is not possible, as a copy of the
+ * data. The view keeps the underlying memory alive.
+ *
+ * @tparam T The element type.
+ */
+template <typename T>
+class VariableView {
+ public:
+  VariableView() = default;
+
+  /** Create view.
+   *
+   * @param memory Pointer keeping the viewed memory alive.
+   * @param data The viewed elements.
+   * @param shape The shape of the variable.
+   * @param mapped Whether the data is viewed directly in the file's mapping.
+   */
+  VariableView(std::shared_ptr<const void> memory,
+               std::span<const T> data,
+               std::vector<size_t> shape,
+               bool mapped)
+      : memory_(memory), data_(data), shape_(shape), mapped_(mapped) {}
+
+  /// The elements of the variable in row-major order.
+  std::span<const T> span() const { return data_; }
+  const T* data() const { return data_.data(); }
+  size_t size() const { return data_.size(); }
+  const T* begin() const { return data_.data(); }
+  const T* end() const { return data_.data() + data_.size(); }
+  const T& operator[](size_t index) const { return data_[index]; }
+
+  /// The shape of the variable.
+  const std::vector<size_t>& shape() const { return shape_; }
+
+  /// Whether the data is viewed in the mapping of the file without a copy.
+  bool is_mapped() const { return mapped_; }
+
+ private:
+  std::shared_ptr<const void> memory_ = nullptr;
+  std::span<const T> data_ = {};
+  std::vector<size_t> shape_ = {};
+  bool mapped_ = false;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// N-dimensional arrays
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/** Strided array concept.
+ *
+ * Matches non-owning views of N-dimensional arrays that expose the
+ * interface of std::mdspan with a strided layout: a static rank, the
+ * extent and the stride in elements of each dimension and a pointer to
+ * the first element. Both StridedView and std::mdspan with layout_right,
+ * layout_left or layout_stride satisfy it.
+ */
+template <typename View>
+concept StridedArray = requires(const View& view, size_t dim) {
+  typename View::element_type;
+  { View::rank() } -> std::convertible_to<size_t>;
+  { view.extent(dim) } -> std::convertible_to<size_t>;
+  { view.stride(dim) } -> std::convertible_to<ptrdiff_t>;
+  { view.data_handle() } -> std::convertible_to<const typename View::element_type*>;
+};
+
+// Number of elements of an array with the given extents.
+template <typename Extents>
+size_t n_elements(const Extents& extents) {
+  size_t result = 1;
+  for (auto extent : extents) {
+    result *= extent;
+  }
+  return result;
+}
+
+// Row-major strides of an array with the given extents.
+template <size_t N>
+std::array<ptrdiff_t, N> row_major_strides(const std::array<size_t, N>& extents) {
+  std::array<ptrdiff_t, N> strides{};
+  ptrdiff_t stride = 1;
+  for (size_t i = N; i > 0; --i) {
+    strides[i - 1] = stride;
+    stride *= static_cast<ptrdiff_t>(extents[i - 1]);
+  }
+  return strides;
+}
+
+}  // namespace detail
+
+/** Strided view of an N-dimensional array.
+ *
+ * Non-owning view of an N-dimensional array with arbitrary element
+ * strides, for example a slice of a larger array. The view provides the
+ * subset of the std::mdspan interface used by the read and write methods
+ * of Variable, so that either type can be passed to them.
+ *
+ * @tparam T The element type. Const for read-only views.
+ * @tparam N The number of dimensions.
+ */
+template <typename T, size_t N>
+class StridedView {
+ public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+
+  /** Create view of contiguous array in row-major order.
+   *
+   * @param data Pointer to the first element.
+   * @param extents The extents of the array.
+   */
+  StridedView(T* data, std::array<size_t, N> extents)
+      : data_(data),
+        extents_(extents),
+        strides_(detail::row_major_strides(extents)) {}
+
+  /** Create strided view.
+   *
+   * @param data Pointer to the first element.
+   * @param extents The extents of the array.
+   * @param strides The distance in elements between consecutive
+   *     elements along each dimension.
+   */
+  StridedView(T* data,
+              std::array<size_t, N> extents,
+              std::array<ptrdiff_t, N> strides)
+      : data_(data), extents_(extents), strides_(strides) {}
+
+  /// Views of mutable arrays convert to read-only views.
+  template <typename U>
+    requires(std::is_same_v<const U, T> && !std::is_same_v<U, T>)
+  StridedView(const StridedView<U, N>& other)
+      : data_(other.data_handle()),
+        extents_(other.extents()),
+        strides_(other.strides()) {}
+
+  static constexpr size_t rank() { return N; }
+  size_t extent(size_t dim) const { return extents_[dim]; }
+  ptrdiff_t stride(size_t dim) const { return strides_[dim]; }
+  const std::array<size_t, N>& extents() const { return extents_; }
+  const std::array<ptrdiff_t, N>& strides() const { return strides_; }
+  T* data_handle() const { return data_; }
+
+  /// The number of elements in the view.
+  size_t size() const { return detail::n_elements(extents_); }
+
+  /// Access element by its indices.
+  template <typename... Indices>
+    requires(sizeof...(Indices) == N)
+  T& operator()(Indices... indices) const {
+    std::array<size_t, N> index{static_cast<size_t>(indices)...};
+    ptrdiff_t offset = 0;
+    for (size_t i = 0; i < N; ++i) {
+      offset += static_cast<ptrdiff_t>(index[i]) * strides_[i];
+    }
+    return data_[offset];
+  }
+
+  /** View of a hyperslab of the array.
+   *
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @return View of the hyperslab sharing the strides of this view.
+   */
+  StridedView slice(std::array<size_t, N> starts, std::array<size_t, N> counts) const {
+    T* data = data_;
+    for (size_t i = 0; i < N; ++i) {
+      if (starts[i] + counts[i] > extents_[i]) {
+        throw std::out_of_range("Slice exceeds extents of the view.");
+      }
+      data += static_cast<ptrdiff_t>(starts[i]) * strides_[i];
+    }
+    return StridedView(data, counts, strides_);
+  }
+
+  /// Whether the elements are contiguous in row-major order.
+  bool is_contiguous() const {
+    return strides_ == detail::row_major_strides(extents_);
+  }
+
+ private:
+  T* data_;
+  std::array<size_t, N> extents_;
+  std::array<ptrdiff_t, N> strides_;
+};
+
+/** Owning N-dimensional array.
+ *
+ * Contiguous N-dimensional array in row-major order as returned by
+ * Variable::read_array.
+ *
+ * @tparam T The element type.
+ * @tparam N The number of dimensions.
+ */
+template <typename T, size_t N>
+class NDArray {
+ public:
+  NDArray() = default;
+
+  /** Create array.
+   *
+   * @param shape The shape of the array.
+   * @param value The initial value of the elements.
+   */
+  explicit NDArray(std::array<size_t, N> shape, const T& value = T())
+      : shape_(shape), data_(detail::n_elements(shape), value) {}
+
+  const std::array<size_t, N>& shape() const { return shape_; }
+  static constexpr size_t rank() { return N; }
+  size_t size() const { return data_.size(); }
+  T* data() { return data_.data(); }
+  const T* data() const { return data_.data(); }
+  auto begin() { return data_.begin(); }
+  auto end() { return data_.end(); }
+  auto begin() const { return data_.begin(); }
+  auto end() const { return data_.end(); }
+
+  /// The elements in row-major order.
+  const std::vector<T>& vector() const { return data_; }
+
+  /// Access element by its indices.
+  template <typename... Indices>
+    requires(sizeof...(Indices) == N)
+  T& operator()(Indices... indices) { return view()(indices...); }
+  template <typename... Indices>
+    requires(sizeof...(Indices) == N)
+  const T& operator()(Indices... indices) const { return view()(indices...); }
+
+  /// View of the array.
+  StridedView<T, N> view() { return StridedView<T, N>(data_.data(), shape_); }
+  StridedView<const T, N> view() const {
+    return StridedView<const T, N>(data_.data(), shape_);
+  }
+
+ private:
+  std::array<size_t, N> shape_ = {};
+  std::vector<T> data_ = {};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// I/O executor
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail {
+
+/** I/O executor.
+ *
+ * Runs tasks in order of submission on a fixed number of dedicated
+ * threads. Since the NetCDF-c library isn't thread-safe and keeps global
+ * state, all asynchronous I/O of the process is serialized on the
+ * single-threaded executor returned by get. Coroutines that await I/O
+ * are resumed on the executor returned by continuations, so that they
+ * can't delay or block the I/O thread. That executor is owned by the
+ * I/O executor and only started when a coroutine first awaits I/O.
+ */
+class IOExecutor {
+ public:
+  /** Start executor.
+   *
+   * @param n_threads The number of threads that run tasks.
+   */
+  explicit IOExecutor(size_t n_threads = 1) {
+    threads_.reserve(n_threads);
+    for (size_t i = 0; i < n_threads; ++i) {
+      threads_.emplace_back([this] { run(); });
+    }
+  }
+  IOExecutor(const IOExecutor&) = delete;
+  IOExecutor& operator=(const IOExecutor&) = delete;
+
+  /// Finishes all queued tasks and stops the threads.
+  ~IOExecutor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    condition_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    // Tasks may post continuations until here, so the continuation
+    // executor is only destroyed after the threads have finished.
+    continuations_.reset();
+  }
+
+  /// The executor shared by all asynchronous I/O of the process.
+  static IOExecutor& get() {
+    static IOExecutor executor;
+    return executor;
+  }
+
+  /** The executor on which coroutines are resumed after awaiting I/O.
+   *
+   * Started on first use with the number of threads set by
+   * set_continuation_threads.
+   */
+  IOExecutor& continuations() {
+    std::call_once(continuations_started_, [this] {
+      continuations_ = std::make_unique<IOExecutor>(continuation_threads());
+    });
+    return *continuations_;
+  }
+
+  /** Set the number of threads of continuation executors.
+   *
+   * Only affects executors whose continuations haven't been started yet.
+   *
+   * @param n_threads The number of threads. 0 selects the default of
+   *     hardware_concurrency() threads, but at most 4.
+   */
+  static void set_continuation_threads(size_t n_threads) {
+    continuation_threads_ = n_threads;
+  }
+
+  /// The number of threads with which continuation executors are started.
+  static size_t continuation_threads() {
+    size_t n_threads = continuation_threads_;
+    if (n_threads == 0) {
+      n_threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 4);
+    }
+    return n_threads;
+  }
+
+  /** Enqueue task.
+   *
+   * @param task The task to run on the executor thread.
+   */
+  void post(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    condition_.notify_one();
+  }
+
+  /** Enqueue task and retrieve its result.
+   *
+   * Calls from one of the executor's own threads are run directly, so
+   * that waiting for the returned future from within a task can't
+   * deadlock.
+   *
+   * @param call The callable to run on the executor thread.
+   * @return Future holding the result of the call or the exception
+   *     that it threw.
+   */
+  template <typename F>
+  std::future<std::invoke_result_t<F>> submit(F&& call) {
+    using Result = std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(call));
+    auto future = task->get_future();
+    if (on_executor_thread()) {
+      (*task)();
+    } else {
+      post([task] { (*task)(); });
+    }
+    return future;
+  }
+
+  /** Run call on the executor thread and wait for its result.
+   *
+   * Calls from the executor thread itself are run directly.
+   */
+  template <typename F>
+  std::invoke_result_t<F> run_sync(F&& call) {
+    if (on_executor_thread()) {
+      return call();
+    }
+    return submit(std::forward<F>(call)).get();
+  }
+
+  /// Whether the calling thread is one of the executor's threads.
+  bool on_executor_thread() const {
+    auto id = std::this_thread::get_id();
+    return std::any_of(threads_.begin(), threads_.end(), [id](auto& thread) {
+      return thread.get_id() == id;
+    });
+  }
+
+ private:
+  void run() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_ = false;
+  std::vector<std::thread> threads_;
+  std::once_flag continuations_started_;
+  std::unique_ptr<IOExecutor> continuations_ = nullptr;
+  static inline std::atomic<size_t> continuation_threads_ = 0;
+};
+
+}  // namespace detail
+
+/** Set the number of threads on which awaiting coroutines are resumed.
+ *
+ * Must be called before the first coroutine awaits I/O to take effect.
+ *
+ * @param n_threads The number of threads. 0 selects the default of
+ *     hardware_concurrency() threads, but at most 4.
+ */
+inline void set_continuation_threads(size_t n_threads) {
+  detail::IOExecutor::set_continuation_threads(n_threads);
+}
+
+/** Awaitable I/O operation.
+ *
+ * Awaiting the operation suspends the awaiting coroutine and runs the
+ * operation on the I/O executor thread, so that any number of
+ * coroutines can wait for I/O without occupying a thread each. Once the
+ * operation has finished, the coroutine is resumed on a thread of the
+ * continuation executor. It may therefore block on other asynchronous
+ * I/O, but must access files that other requests are pending on only
+ * through the asynchronous interfaces.
+ *
+ * @tparam Result The result type of the operation.
+ */
+template <typename Result>
+class IOAwaitable {
+  using Storage = std::conditional_t<std::is_void_v<Result>, bool, Result>;
+
+ public:
+  /** Create awaitable.
+   *
+   * @param call The operation to run on the executor thread.
+   */
+  explicit IOAwaitable(std::function<Result()> call) : call_(std::move(call)) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    auto& executor = detail::IOExecutor::get();
+    auto& continuations = executor.continuations();
+    executor.post([this, handle, &continuations] {
+      try {
+        if constexpr (std::is_void_v<Result>) {
+          call_();
+        } else {
+          result_.emplace(call_());
+        }
+      } catch (...) {
+        error_ = std::current_exception();
+      }
+      continuations.post([handle] { handle.resume(); });
+    });
+  }
+
+  Result await_resume() {
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+    if constexpr (!std::is_void_v<Result>) {
+      return std::move(*result_);
+    }
+  }
+
+ private:
+  std::function<Result()> call_;
+  std::optional<Storage> result_ = std::nullopt;
+  std::exception_ptr error_ = nullptr;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// NetCDF Variable
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+class RecordAppender;
+template <typename T, size_t N_DIMS>
+class WriteQueue;
+template <typename T>
+class RecordReader;
+
+/** NetCDF variable
+ *
+ * Represents a variable in a NetCDF File.
+ *
+ */
+class Variable {
+  friend class DefineTransaction;
+  template <typename T>
+  friend class RecordAppender;
+  template <typename T, size_t N_DIMS>
+  friend class WriteQueue;
+  template <typename T>
+  friend class RecordReader;
+
+ private:
+
+  // Issues library call on this variable through the file's
+  // instrumentation.
+  template <typename F>
+  int instrument(CallCategory category, F&& call, size_t bytes = 0) const {
+    return file_ptr_->instrument(
+        category, std::forward<F>(call), parent_id_, id_, bytes);
+  }
+
+  // Size of hyperslab of elements of type T in bytes. Only computed in
+  // instrumented builds.
+  template <typename T>
+  size_t hyperslab_bytes([[maybe_unused]] const size_t* counts) const {
+    if constexpr (instrumentation_enabled) {
+      size_t result = sizeof(T);
+      for (size_t i = 0; i < dimensions_.size(); ++i) {
+        result *= counts[i];
+      }
+      return result;
+    }
+    return 0;
+  }
+
+  // Size of the whole variable as elements of type T in bytes. Only
+  // computed in instrumented builds.
+  template <typename T>
+  size_t variable_bytes() const {
+    if constexpr (instrumentation_enabled) {
+      size_t result = sizeof(T);
+      for (auto& dim : dimensions_) {
+        size_t extent = 0;
+        instrument(CallCategory::Inquire, [&] {
+          return nc_inq_dimlen(parent_id_, dim.id, &extent);
+        });
+        result *= extent;
+      }
+      return result;
+    }
+    return 0;
+  }
+
+  // Adds arguments of a data transfer on this variable to trace span.
+  void add_trace_args(detail::TraceSpan& span,
+                      const size_t* starts,
+                      const size_t* counts,
+                      size_t bytes) const {
+    span.add_arg("variable", std::string(name_));
+    if (starts) {
+      span.add_arg("starts", starts, dimensions_.size());
+      span.add_arg("counts", counts, dimensions_.size());
+    }
+    span.add_arg("bytes", bytes);
+  }
+
+  // Parses dimensions of this variable.
+  void parse_dimensions() {
+    int n_dims = dimensions_.capacity();
+    auto dim_ids = std::make_unique<int[]>(n_dims);
+    int error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_vardimid(parent_id_, id_, dim_ids.get());
+    });
+    detail::handle_error("Error inquiring dimension IDs of variable:", error);
+
+    for (int i = 0; i < n_dims; ++i) {
+      int dim_id = dim_ids[i];
+      Dimension dim{dim_id};
+      error = instrument(CallCategory::Inquire, [&] {
+        return nc_inq_dim(parent_id_, dim_id, dim.name, &dim.size);
+      });
+      detail::handle_error("Error inquiring dimension:", error);
+      dimensions_.push_back(dim);
+    }
+  }
+
+  // Grows the chunk cache to hold all chunks touched by the given
+  // hyperslab.
+  ChunkCache fit_chunk_cache(const size_t* starts,
+                             const size_t* counts,
+                             size_t max_size) {
+    ChunkCache cache = get_chunk_cache();
+    int layout = 0;
+    std::vector<size_t> chunk_sizes(dimensions_.size());
+    int error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_var_chunking(parent_id_, id_, &layout, chunk_sizes.data());
+    });
+    detail::handle_error("Error inquiring variable chunking:", error);
+    if (layout != NC_CHUNKED) {
+      return cache;
+    }
+
+    size_t element_size = 0;
+    error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_type(parent_id_, static_cast<int>(type_), 0, &element_size);
+    });
+    detail::handle_error("Error inquiring type size:", error);
+
+    size_t n_chunks = 1;
+    size_t chunk_bytes = element_size;
+    for (size_t i = 0; i < chunk_sizes.size(); ++i) {
+      size_t count = std::max<size_t>(counts[i], 1);
+      size_t first = starts[i] / chunk_sizes[i];
+      size_t last = (starts[i] + count - 1) / chunk_sizes[i];
+      n_chunks *= last - first + 1;
+      chunk_bytes *= chunk_sizes[i];
+    }
+
+    size_t size = std::min(n_chunks * chunk_bytes, max_size);
+    if (size > cache.size) {
+      cache.size = size;
+      cache.n_elements =
+          std::max(cache.n_elements, detail::next_prime(10 * n_chunks));
+      set_chunk_cache(cache);
+    }
+    return cache;
+  }
+
+  // Fits the chunk cache if the shape of the hyperslab differs from the
+  // one the cache was last fitted to.
+  void auto_fit_chunk_cache(const size_t* starts, const size_t* counts) {
+    if (!std::equal(counts, counts + dimensions_.size(),
+                    fitted_counts_.begin(), fitted_counts_.end())) {
+      fit_chunk_cache(starts, counts, size_t(1) << 30);
+      fitted_counts_.assign(counts, counts + dimensions_.size());
+    }
+  }
+
+  // Current shape of the variable, including the current size of
+  // unlimited dimensions.
+  std::vector<size_t> current_shape() const {
+    std::vector<size_t> result(dimensions_.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+      int error = instrument(CallCategory::Inquire, [&] {
+        return nc_inq_dimlen(parent_id_, dimensions_[i].id, &result[i]);
+      });
+      detail::handle_error("Error inquiring dimension length:", error);
+    }
+    return result;
+  }
+
+  // Current number of elements in the variable.
+  size_t current_size() const {
+    size_t result = 1;
+    for (auto& extent : current_shape()) {
+      result *= extent;
+    }
+    return result;
+  }
+
+  // Reads hyperslab in the variable's type and converts it to T.
+  template <typename T>
+  void read_converted(const size_t* starts,
+                      const size_t* counts,
+                      T* data,
+                      Conversion conversion) {
+    detail::TraceSpan span("Variable::read_as", "read");
+    if (span) {
+      add_trace_args(span, starts, counts, hyperslab_bytes<T>(counts));
+    }
+    detail::assert_write_mode(*file_ptr_);
+    if (conversion == Conversion::Library || TypeProperties<T>::value == type_) {
+      int error = instrument(CallCategory::Read, [&] {
+        return TypeProperties<T>::read_array(parent_id_, id_, starts, counts, data);
+      }, hyperslab_bytes<T>(counts));
+      detail::handle_error("Error reading variable:", error);
+      return;
+    }
+    size_t n = 1;
+    for (size_t i = 0; i < dimensions_.size(); ++i) {
+      n *= counts[i];
+    }
+    dispatch(type_, [&](auto tag) {
+      using S = typename decltype(tag)::type;
+      if constexpr (!std::is_arithmetic_v<S> || std::is_same_v<S, char>) {
+        check_type<T>();
+      } else if constexpr (sizeof(S) <= sizeof(T)) {
+        S* packed = detail::packed_values<S>(data, n);
+        int error = instrument(CallCategory::Read, [&] {
+          return TypeProperties<S>::read_array(parent_id_, id_, starts, counts, packed);
+        }, hyperslab_bytes<S>(counts));
+        detail::handle_error("Error reading variable:", error);
+        detail::convert_in_place<S>(data, n, [](const S* s, T* d, size_t m) {
+          detail::convert(s, d, m);
+        });
+      } else {
+        auto buffer = std::make_unique_for_overwrite<S[]>(n);
+        int error = instrument(CallCategory::Read, [&] {
+          return TypeProperties<S>::read_array(
+              parent_id_, id_, starts, counts, buffer.get());
+        }, hyperslab_bytes<S>(counts));
+        detail::handle_error("Error reading variable:", error);
+        detail::convert(buffer.get(), data, n);
+      }
+    });
+  }
+
+  // Converts data from T to the variable's type and writes it to hyperslab.
+  template <typename T>
+  void write_converted(const size_t* starts,
+                       const size_t* counts,
+                       const T* data,
+                       Conversion conversion) {
+    detail::TraceSpan span("Variable::write_as", "write");
+    if (span) {
+      add_trace_args(span, starts, counts, hyperslab_bytes<T>(counts));
+    }
+    file_ptr_->assert_writable();
+    detail::assert_write_mode(*file_ptr_);
+    if (conversion == Conversion::Library || TypeProperties<T>::value == type_) {
+      int error = instrument(CallCategory::Write, [&] {
+        return TypeProperties<T>::write_array(parent_id_, id_, starts, counts, data);
+      }, hyperslab_bytes<T>(counts));
+      detail::handle_error("Error writing variable:", error);
+      return;
+    }
+    size_t n = 1;
+    for (size_t i = 0; i < dimensions_.size(); ++i) {
+      n *= counts[i];
+    }
+    dispatch(type_, [&](auto tag) {
+      using S = typename decltype(tag)::type;
+      if constexpr (!std::is_arithmetic_v<S> || std::is_same_v<S, char>) {
+        check_type<T>();
+      } else {
+        auto buffer = std::make_unique_for_overwrite<S[]>(n);
+        detail::convert(data, buffer.get(), n);
+        int error = instrument(CallCategory::Write, [&] {
+          return TypeProperties<S>::write_array(
+              parent_id_, id_, starts, counts, buffer.get());
+        }, hyperslab_bytes<S>(counts));
+        detail::handle_error("Error writing variable:", error);
+      }
+    });
+  }
+
+  // Reads numeric attribute of variable as doubles. Returns false
+  // if the variable has no attribute of the given name.
+  bool read_attribute_values(const char* name,
+                             std::vector<double>& values,
+                             Type& type) const {
+    if (!attributes_.has(name)) {
+      return false;
+    }
+    auto& attribute = attributes_.get(name);
+    type = attribute.get_type();
+    values = attribute.get_values<double>();
+    return true;
+  }
+
+  // Returns CF packing parameters, re-parsing them if the variable's
+  // attributes changed.
+  const CFPacking& cf_packing() {
+    if (!cf_packing_ || cf_packing_version_ != attributes_.version()) {
+      cf_packing_ = std::make_shared<CFPacking>(parse_cf_packing());
+      cf_packing_version_ = attributes_.version();
+    }
+    return *cf_packing_;
+  }
+
+  // Parses the CF packing attributes of the variable.
+  CFPacking parse_cf_packing() const {
+    CFPacking packing{};
+    std::vector<double> values;
+    Type att_type;
+    if (read_attribute_values("scale_factor", values, att_type) && values.size()) {
+      packing.scale_factor = values[0];
+    }
+    if (read_attribute_values("add_offset", values, att_type) && values.size()) {
+      packing.add_offset = values[0];
+    }
+    if (read_attribute_values("missing_value", values, att_type) && values.size()) {
+      packing.has_missing_value = true;
+      packing.missing_value = values[0];
+    }
+
+    // Fill value, falling back to the default fill value of the type.
+    if (type_ != Type::String && type_ != Type::Char) {
+      int no_fill = 0;
+      std::array<char, 8> fill_value;
+      int error = instrument(CallCategory::Inquire, [&] {
+        return nc_inq_var_fill(parent_id_, id_, &no_fill, fill_value.data());
+      });
+      detail::handle_error("Error inquiring fill value:", error);
+      // An explicit _FillValue marks missing data even if the variable
+      // isn't prefilled.
+      if (!no_fill || attributes_.has("_FillValue")) {
+        packing.has_fill_value = true;
+        dispatch(type_, [&](auto tag) {
+          using T = typename decltype(tag)::type;
+          if constexpr (std::is_arithmetic_v<T>) {
+            T value;
+            std::memcpy(&value, fill_value.data(), sizeof(T));
+            packing.fill_value = static_cast<double>(value);
+          }
+        });
+      }
+    }
+
+    // Valid range given in the type of the packed data is in packed
+    // representation, otherwise it refers to the unpacked values.
+    double valid_min = 0.0, valid_max = 0.0;
+    bool has_valid_min = false, has_valid_max = false;
+    bool packed = true;
+    if (read_attribute_values("valid_range", values, att_type) && values.size() == 2) {
+      valid_min = values[0];
+      valid_max = values[1];
+      has_valid_min = has_valid_max = true;
+      packed = att_type == type_;
+    } else {
+      if (read_attribute_values("valid_min", values, att_type) && values.size()) {
+        valid_min = values[0];
+        has_valid_min = true;
+        packed = att_type == type_;
+      }
+      if (read_attribute_values("valid_max", values, att_type) && values.size()) {
+        valid_max = values[0];
+        has_valid_max = true;
+        packed = att_type == type_;
+      }
+    }
+    if (!packed) {
+      valid_min = (valid_min - packing.add_offset) / packing.scale_factor;
+      valid_max = (valid_max - packing.add_offset) / packing.scale_factor;
+      if (packing.scale_factor < 0.0) {
+        std::swap(valid_min, valid_max);
+        std::swap(has_valid_min, has_valid_max);
+      }
+    }
+    packing.has_valid_min = has_valid_min;
+    packing.valid_min = valid_min;
+    packing.has_valid_max = has_valid_max;
+    packing.valid_max = valid_max;
+    return packing;
+  }
+
+  // Reads hyperslab and decodes it according to the CF conventions.
+  template <typename T>
+  void read_decoded(const size_t* starts, const size_t* counts, T* data) {
+    static_assert(std::is_floating_point_v<T>,
+                  "CF decoding requires a floating point destination type.");
+    detail::TraceSpan span("Variable::read_cf", "read");
+    if (span) {
+      add_trace_args(span, starts, counts, hyperslab_bytes<T>(counts));
+    }
+    const CFPacking& packing = cf_packing();
+    detail::assert_write_mode(*file_ptr_);
+    size_t n = 1;
+    for (size_t i = 0; i < dimensions_.size(); ++i) {
+      n *= counts[i];
+    }
+    dispatch(type_, [&](auto tag) {
+      using S = typename decltype(tag)::type;
+      if constexpr (!std::is_arithmetic_v<S> || std::is_same_v<S, char>) {
+        check_type<T>();
+      } else if constexpr (sizeof(S) <= sizeof(T)) {
+        S* packed = detail::packed_values<S>(data, n);
+        int error = instrument(CallCategory::Read, [&] {
+          return TypeProperties<S>::read_array(parent_id_, id_, starts, counts, packed);
+        }, hyperslab_bytes<S>(counts));
+        detail::handle_error("Error reading variable:", error);
+        detail::convert_in_place<S>(data, n, [&packing](const S* s, T* d, size_t m) {
+          detail::decode_cf(s, d, m, packing);
+        });
+      } else {
+        auto buffer = std::make_unique_for_overwrite<S[]>(n);
+        int error = instrument(CallCategory::Read, [&] {
+          return TypeProperties<S>::read_array(
+              parent_id_, id_, starts, counts, buffer.get());
+        }, hyperslab_bytes<S>(counts));
+        detail::handle_error("Error reading variable:", error);
+        detail::decode_cf(buffer.get(), data, n, packing);
+      }
+    });
+  }
+
+#if defined(NETCDFHPP_WITH_HDF5) && defined(NETCDFHPP_HAS_MMAP)
+  // Whether the variable's data is stored in native byte order.
+  bool has_native_byte_order() const {
+    int endianness = NC_ENDIAN_NATIVE;
+    int error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_var_endian(parent_id_, id_, &endianness);
+    });
+    detail::handle_error("Error inquiring variable endianness:", error);
+    int native = std::endian::native == std::endian::little ? NC_ENDIAN_LITTLE
+                                                            : NC_ENDIAN_BIG;
+    return endianness == NC_ENDIAN_NATIVE || endianness == native;
+  }
+
+  // Returns the mapping of the file, which is shared by all variables of
+  // the file. Pending writes are flushed and the file is mapped again
+  // only if it was modified since it was last mapped.
+  std::shared_ptr<const MappedFile> map_file() {
+    auto& file = *file_ptr_;
+    if (file.mapping && file.mapped_modifications == file.modifications) {
+      return file.mapping;
+    }
+    if (!file.read_only) {
+      detail::assert_write_mode(file);
+      int error = instrument(CallCategory::Sync, [&] { return nc_sync(file.id); });
+      detail::handle_error("Error syncing file:", error);
+    }
+    if (file.mapped_path.empty()) {
+      size_t length = 0;
+      int error = instrument(CallCategory::Inquire, [&] {
+        return nc_inq_path(file.id, &length, nullptr);
+      });
+      detail::handle_error("Error inquiring file path:", error);
+      std::string path(length, '\0');
+      error = instrument(CallCategory::Inquire, [&] {
+        return nc_inq_path(file.id, &length, path.data());
+      });
+      detail::handle_error("Error inquiring file path:", error);
+      file.mapped_path = path;
+    }
+    file.mapping = MappedFile::map(file.mapped_path);
+    file.mapped_modifications = file.modifications;
+    file.chunk_indices.clear();
+    return file.mapping;
+  }
+
+  // Opens the HDF5 dataset that holds the data of the variable. Must be
+  // preceded by map_file(), which flushes pending writes.
+  std::unique_ptr<detail::HDF5Dataset> open_hdf5_dataset() {
+    size_t length = 0;
+    int error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_grpname_full(parent_id_, &length, nullptr);
+    });
+    detail::handle_error("Error inquiring group name:", error);
+    std::string group_name(length, '\0');
+    error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_grpname_full(parent_id_, &length, group_name.data());
+    });
+    detail::handle_error("Error inquiring group name:", error);
+    return std::make_unique<detail::HDF5Dataset>(
+        file_ptr_->mapped_path, group_name, name_);
+  }
+#endif
+
+  // Reads the variable by decompressing its chunks in parallel. Returns
+  // false if the variable's storage isn't supported.
+  template <typename T>
+  bool read_chunks_parallel([[maybe_unused]] T* data,
+                            [[maybe_unused]] size_t n_threads) {
+#if defined(NETCDFHPP_WITH_HDF5) && defined(NETCDFHPP_HAS_MMAP)
+    if (!std::is_arithmetic_v<T> || file_ptr_->in_memory || file_ptr_->memory) {
+      return false;
+    }
+    auto shape = current_shape();
+    if (shape.empty() || detail::n_elements(shape) == 0 ||
+        get_storage().layout != Layout::Chunked || !has_native_byte_order()) {
+      return false;
+    }
+    auto mapping = map_file();
+    auto& indices = file_ptr_->chunk_indices;
+    auto found = indices.find({parent_id_, id_});
+    if (found == indices.end()) {
+      std::shared_ptr<const detail::ChunkIndex> index = nullptr;
+      auto dataset = open_hdf5_dataset();
+      if (*dataset) {
+        index = detail::index_chunks(dataset->id(), shape, mapping->bytes().size());
+      }
+      found = indices.emplace(std::make_pair(parent_id_, id_), index).first;
+    }
+    auto index = found->second;
+    if (!index || index->shape != shape) {
+      return false;
+    }
+    bool success = false;
+    instrument(CallCategory::Read, [&] {
+      success = detail::read_chunks_parallel(*index,
+                                             mapping->bytes(),
+                                             sizeof(T),
+                                             reinterpret_cast<std::byte*>(data),
+                                             n_threads);
+      return NC_NOERR;
+    }, variable_bytes<T>());
+    return success;
+#else
+    return false;
+#endif
+  }
+
+  // Maps the variable's data if it is stored contiguously and unfiltered.
+  template <typename T>
+  std::optional<VariableView<T>> map_contiguous(
+      [[maybe_unused]] const std::vector<size_t>& shape,
+      [[maybe_unused]] size_t n) {
+#if defined(NETCDFHPP_WITH_HDF5) && defined(NETCDFHPP_HAS_MMAP)
+    if (!std::is_arithmetic_v<T> || n == 0 || file_ptr_->in_memory ||
+        file_ptr_->memory) {
+      return std::nullopt;
+    }
+    auto storage = get_storage();
+    if (storage.layout != Layout::Contiguous || storage.deflate_level > 0 ||
+        storage.shuffle || storage.fletcher32) {
+      return std::nullopt;
+    }
+    size_t n_filters = 0;
+    int error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_var_filter_ids(parent_id_, id_, &n_filters, nullptr);
+    });
+    detail::handle_error("Error inquiring variable filters:", error);
+    if (n_filters > 0 || !has_native_byte_order()) {
+      return std::nullopt;
+    }
+
+    auto mapping = map_file();
+    auto dataset = open_hdf5_dataset();
+    haddr_t offset = HADDR_UNDEF;
+    if (*dataset) {
+      H5E_BEGIN_TRY {
+        offset = H5Dget_offset(dataset->id());
+      } H5E_END_TRY;
+    }
+    if (offset == HADDR_UNDEF) {
+      return std::nullopt;
+    }
+
+    auto bytes = mapping->bytes();
+    if (offset + n * sizeof(T) > bytes.size() || offset % alignof(T) != 0) {
+      return std::nullopt;
+    }
+    const T* data = reinterpret_cast<const T*>(bytes.data() + offset);
+    return VariableView<T>(mapping, std::span<const T>(data, n), shape, true);
+#else
+    return std::nullopt;
+#endif
+  }
+
+  // Checks that an array of the given rank matches the dimensions of
+  // the variable.
+  void check_rank(size_t rank) const {
+    if (rank != dimensions_.size()) {
+      std::stringstream msg;
+      msg << "Array of rank " << rank << " is incompatible with variable "
+          << name_ << " of rank " << dimensions_.size() << "." << std::endl;
+      throw std::runtime_error(msg.str());
+    }
+  }
+
+  // Extents and element strides of a strided array.
+  template <size_t N_DIMS, detail::StridedArray View>
+  static std::pair<std::array<size_t, N_DIMS>, std::array<ptrdiff_t, N_DIMS>>
+  get_layout(const View& view) {
+    static_assert(View::rank() == N_DIMS,
+                  "Rank of array must match the number of start indices.");
+    std::array<size_t, N_DIMS> counts{};
+    std::array<ptrdiff_t, N_DIMS> map{};
+    for (size_t i = 0; i < N_DIMS; ++i) {
+      counts[i] = static_cast<size_t>(view.extent(i));
+      map[i] = static_cast<ptrdiff_t>(view.stride(i));
+    }
+    return {counts, map};
+  }
+
+  // Checks that NetCDF type is compatible with provided C++ type.
+  template <typename T>
+  void check_type() {
+      if (TypeProperties<T>::value != type_) {
+          std::stringstream msg;
+          msg << "Provided type " << TypeProperties<T>::value << " is incompatible "
+              << "with NetCDF type " << type_ << std::endl;
+          throw std::runtime_error(msg.str());
+      }
+  }
+
+public:
+
+  Variable() {}
+
+  /** Create variable.
+   *
+   * This creates a variable and parses its dimensions and attributes.
+   *
+   * @param file_ptr Shared pointer to file object to which this variable belongs.
+   * @param parent_id NetCDF ID of the parent group of this variable.
+   * @param id The variabl ID that identifies this variable in the NetCDF-c library.
+   */
+  Variable(std::shared_ptr<detail::FileID> file_ptr, int parent_id, int id)
+      : id_(id), parent_id_(parent_id), file_ptr_(file_ptr) {
+    int n_dims, n_attrs, type;
+    int error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_var(parent_id_, id_, name_, &type, &n_dims, 0, &n_attrs);
+    });
+    detail::handle_error("Error inquiring variable:", error);
+    type_ = Type(type);
+    dimensions_.reserve(n_dims);
+    parse_dimensions();
+    attributes_ = detail::Attributes(*file_ptr_, parent_id_, id_);
+  }
+
+  /** Write data to variable.
+     *
+     * @tparam T The datatype to write to the variable.
+     * @param data Start pointer to the destination of the read operation.
+     */
+  template <typename T>
+  void write(T* data) {
+    using TypeTraits = TypeProperties<T>;
+    check_type<T>();
+    detail::TraceSpan span("Variable::write", "write");
+    if (span) {
+      add_trace_args(span, nullptr, nullptr, variable_bytes<T>());
+    }
+    file_ptr_->assert_writable();
+    detail::assert_write_mode(*file_ptr_);
+    int error = instrument(CallCategory::Write, [&] {
+      return TypeTraits::write(parent_id_, id_, data);
+    }, variable_bytes<T>());
+    detail::handle_error("Error writing variable:", error);
+  }
+
+  /** Write data to variable.
+   *
+   * Write data to hyperslab of variable memory.
+   *
+   * @tparam T The datatype to write to the variable.
+   * @tparam N_DIM The number of dimensions of the variable.
    * @param starts Array containing the start indices of the hyper-slab specifying
    *     the target for the write operation.
    * @param counts Array containing the lengths of the hyper-slab specifying the
@@ -371,9 +3688,65 @@ public:
              const T* data) {
     using TypeTraits = TypeProperties<T>;
     check_type<T>();
+    detail::TraceSpan span("Variable::write", "write");
+    if (span) {
+      add_trace_args(span, starts.data(), counts.data(), hyperslab_bytes<T>(counts.data()));
+    }
+    file_ptr_->assert_writable();
+    detail::assert_write_mode(*file_ptr_);
+    int error = instrument(CallCategory::Write, [&] {
+      return TypeTraits::write_array(
+          parent_id_, id_, starts.data(), counts.data(), data);
+    }, hyperslab_bytes<T>(counts.data()));
+    detail::handle_error("Error writing variable:", error);
+  }
+
+  /** Write strided array to hyperslab of variable.
+   *
+   * Writes the elements of an N-dimensional array to the hyperslab of
+   * the variable that starts at the given indices and has the extents
+   * of the array. Arrays that aren't contiguous, for example slices of
+   * larger arrays, are written without an intermediate copy.
+   *
+   * @param starts The start indices of the hyperslab.
+   * @param view The array to write. A StridedView or a std::mdspan with
+   *     a strided layout.
+   */
+  template <size_t N_DIMS, detail::StridedArray View>
+  void write(std::array<size_t, N_DIMS> starts, const View& view) {
+    using T = std::remove_const_t<typename View::element_type>;
+    using TypeTraits = TypeProperties<T>;
+    check_type<T>();
+    check_rank(N_DIMS);
+    auto [counts, map] = get_layout<N_DIMS>(view);
+    detail::TraceSpan span("Variable::write", "write");
+    if (span) {
+      add_trace_args(span, starts.data(), counts.data(), hyperslab_bytes<T>(counts.data()));
+    }
+    file_ptr_->assert_writable();
     detail::assert_write_mode(*file_ptr_);
-    TypeTraits::write_array(
-        parent_id_, id_, starts.data(), counts.data(), data);
+    const T* data = view.data_handle();
+    int error = instrument(CallCategory::Write, [&] {
+      if (map == detail::row_major_strides(counts)) {
+        return TypeTraits::write_array(
+            parent_id_, id_, starts.data(), counts.data(), data);
+      }
+      return TypeTraits::write_mapped(
+          parent_id_, id_, starts.data(), counts.data(), nullptr, map.data(), data);
+    }, hyperslab_bytes<T>(counts.data()));
+    detail::handle_error("Error writing variable:", error);
+  }
+
+  /** Write strided array to variable.
+   *
+   * Writes the array to the hyperslab starting at the origin of the
+   * variable.
+   *
+   * @param view The array to write.
+   */
+  template <detail::StridedArray View>
+  void write(const View& view) {
+    write(std::array<size_t, View::rank()>{}, view);
   }
 
     /** Write single-valued variable.
@@ -386,11 +3759,20 @@ public:
      * @param The value to write.
      */
     template <typename T>
+      requires(!detail::StridedArray<T>)
     void write(T t) {
         using TypeTraits = TypeProperties<T>;
         check_type<T>();
+        detail::TraceSpan span("Variable::write", "write");
+        if (span) {
+          add_trace_args(span, nullptr, nullptr, sizeof(T));
+        }
+        file_ptr_->assert_writable();
         detail::assert_write_mode(*file_ptr_);
-        TypeTraits::write_value(parent_id_, id_, 0, &t);
+        int error = instrument(CallCategory::Write, [&] {
+          return TypeTraits::write_value(parent_id_, id_, detail::zero_index, &t);
+        }, sizeof(T));
+        detail::handle_error("Error writing variable:", error);
     }
 
     /** Read all data from variable.
@@ -402,30 +3784,225 @@ public:
     void read(T* data) {
         using TypeTraits = TypeProperties<T>;
         check_type<T>();
+        detail::TraceSpan span("Variable::read", "read");
+        if (span) {
+          add_trace_args(span, nullptr, nullptr, variable_bytes<T>());
+        }
         detail::assert_write_mode(*file_ptr_);
-        TypeTraits::read(parent_id_, id_, data);
+        int error = instrument(CallCategory::Read, [&] {
+          return TypeTraits::read(parent_id_, id_, data);
+        }, variable_bytes<T>());
+        detail::handle_error("Error reading variable:", error);
+    }
+
+  /** Read all data from variable decompressing chunks in parallel.
+   *
+   * Reads the raw chunks of a deflate-compressed (and optionally shuffled)
+   * variable from a memory mapping of the file and decompresses them on
+   * multiple threads, instead of serially inside the HDF5 library. Falls
+   * back to a regular read for variables that are stored differently,
+   * use other filters or have unwritten chunks, and when the library is
+   * built without HDF5 support (NETCDFHPP_WITH_HDF5).
+   *
+   * @tparam T The type of the variable.
+   * @param data Start pointer to the destination of the read operation.
+   * @param n_threads The number of threads to use. Defaults to the
+   *     number of hardware threads.
+   * @return Whether the chunks were decompressed in parallel.
+   */
+  template <typename T>
+  bool read_parallel(T* data, size_t n_threads = 0) {
+    check_type<T>();
+    detail::TraceSpan span("Variable::read_parallel", "read");
+    if (span) {
+      add_trace_args(span, nullptr, nullptr, variable_bytes<T>());
+    }
+    if (read_chunks_parallel(data, n_threads)) {
+      return true;
     }
+    read(data);
+    return false;
+  }
+
+  /** Read hyperslab of data from variable.
+    *
+    * Read data from hyperslab of variable memory.
+    *
+    * @tparam T The datatype to write to the variable.
+    * @tparam N_DIM The number of dimensions of the variable.
+    * @param starts Array containing the start indices of the hyper-slab specifying
+    *     the source of the read operation.
+    * @param counts Array containing the lengths of the hyper-slab specifying the
+    *     the source of the read operation.
+    * @param data Start pointer to the destination of the read operation.
+    */
+  template <typename T, size_t N_DIMS>
+  void read(std::array<size_t, N_DIMS> starts,
+            std::array<size_t, N_DIMS> counts,
+            T* data) {
+    using TypeTraits = TypeProperties<T>;
+    check_type<T>();
+    detail::TraceSpan span("Variable::read", "read");
+    if (span) {
+      add_trace_args(span, starts.data(), counts.data(), hyperslab_bytes<T>(counts.data()));
+    }
+    detail::assert_write_mode(*file_ptr_);
+    if (chunk_cache_policy_ == ChunkCachePolicy::Auto) {
+      auto_fit_chunk_cache(starts.data(), counts.data());
+    }
+    int error = instrument(CallCategory::Read, [&] {
+      return TypeTraits::read_array(
+          parent_id_, id_, starts.data(), counts.data(), data);
+    }, hyperslab_bytes<T>(counts.data()));
+    detail::handle_error("Error reading variable:", error);
+  }
+
+  /** Read hyperslab of variable into strided array.
+   *
+   * Reads the hyperslab of the variable that starts at the given indices
+   * and has the extents of the destination array. Destinations that
+   * aren't contiguous, for example slices of larger arrays, are filled
+   * without an intermediate copy.
+   *
+   * @param starts The start indices of the hyperslab.
+   * @param view The destination of the read operation. A StridedView or
+   *     a std::mdspan with a strided layout.
+   */
+  template <size_t N_DIMS, detail::StridedArray View>
+  void read(std::array<size_t, N_DIMS> starts, const View& view) {
+    using T = typename View::element_type;
+    static_assert(!std::is_const_v<T>, "Can't read into array of const elements.");
+    using TypeTraits = TypeProperties<T>;
+    check_type<T>();
+    check_rank(N_DIMS);
+    auto [counts, map] = get_layout<N_DIMS>(view);
+    detail::TraceSpan span("Variable::read", "read");
+    if (span) {
+      add_trace_args(span, starts.data(), counts.data(), hyperslab_bytes<T>(counts.data()));
+    }
+    detail::assert_write_mode(*file_ptr_);
+    if (chunk_cache_policy_ == ChunkCachePolicy::Auto) {
+      auto_fit_chunk_cache(starts.data(), counts.data());
+    }
+    T* data = view.data_handle();
+    int error = instrument(CallCategory::Read, [&] {
+      if (map == detail::row_major_strides(counts)) {
+        return TypeTraits::read_array(
+            parent_id_, id_, starts.data(), counts.data(), data);
+      }
+      return TypeTraits::read_mapped(
+          parent_id_, id_, starts.data(), counts.data(), nullptr, map.data(), data);
+    }, hyperslab_bytes<T>(counts.data()));
+    detail::handle_error("Error reading variable:", error);
+  }
+
+  /** Read variable into strided array.
+   *
+   * @param view The destination of the read operation. Its extents must
+   *     match the current shape of the variable.
+   */
+  template <detail::StridedArray View>
+  void read(const View& view) {
+    check_rank(View::rank());
+    auto shape = current_shape();
+    for (size_t i = 0; i < shape.size(); ++i) {
+      if (static_cast<size_t>(view.extent(i)) != shape[i]) {
+        throw std::runtime_error(
+            "Extents of array don't match the shape of variable " +
+            std::string(name_) + ".");
+      }
+    }
+    read(std::array<size_t, View::rank()>{}, view);
+  }
+
+  /** Read hyperslab of variable into N-dimensional array.
+   *
+   * @tparam T The type of the variable.
+   * @tparam N_DIMS The number of dimensions of the variable.
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @return Array holding the data of the hyperslab.
+   */
+  template <typename T, size_t N_DIMS>
+  NDArray<T, N_DIMS> read_array(std::array<size_t, N_DIMS> starts,
+                                std::array<size_t, N_DIMS> counts) {
+    NDArray<T, N_DIMS> result(counts);
+    read(starts, result.view());
+    return result;
+  }
+
+  /** Read variable into N-dimensional array.
+   *
+   * @tparam T The type of the variable.
+   * @tparam N_DIMS The number of dimensions of the variable.
+   * @return Array holding the data of the variable.
+   */
+  template <typename T, size_t N_DIMS>
+  NDArray<T, N_DIMS> read_array() {
+    check_rank(N_DIMS);
+    auto shape = current_shape();
+    std::array<size_t, N_DIMS> counts{};
+    std::copy(shape.begin(), shape.end(), counts.begin());
+    return read_array<T>(std::array<size_t, N_DIMS>{}, counts);
+  }
+
+  /** Read hyperslab asynchronously.
+   *
+   * Awaitable version of the hyperslab read, which is performed on the
+   * I/O executor thread:
+   *
+   *     co_await variable.read_async(starts, counts, data);
+   *
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @param data Destination of the read. Must stay valid until the
+   *     operation has finished.
+   * @return Awaitable operation.
+   */
+  template <typename T, size_t N_DIMS>
+  IOAwaitable<void> read_async(std::array<size_t, N_DIMS> starts,
+                               std::array<size_t, N_DIMS> counts,
+                               T* data) {
+    return IOAwaitable<void>([variable = *this, starts, counts, data]() mutable {
+      variable.read(starts, counts, data);
+    });
+  }
+
+  /** Read hyperslab asynchronously into new buffer.
+   *
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @return Awaitable operation resulting in the data of the hyperslab
+   *     in row-major order.
+   */
+  template <typename T, size_t N_DIMS>
+  IOAwaitable<std::vector<T>> read_async(std::array<size_t, N_DIMS> starts,
+                                         std::array<size_t, N_DIMS> counts) {
+    return IOAwaitable<std::vector<T>>([variable = *this, starts, counts]() mutable {
+      std::vector<T> data(detail::n_elements(counts));
+      variable.read(starts, counts, data.data());
+      return data;
+    });
+  }
 
-  /** Read hyperslab of data from variable.
-    *
-    * Read data from hyperslab of variable memory.
-    *
-    * @tparam T The datatype to write to the variable.
-    * @tparam N_DIM The number of dimensions of the variable.
-    * @param starts Array containing the start indices of the hyper-slab specifying
-    *     the source of the read operation.
-    * @param counts Array containing the lengths of the hyper-slab specifying the
-    *     the source of the read operation.
-    * @param data Start pointer to the destination of the read operation.
-    */
+  /** Write hyperslab asynchronously.
+   *
+   * Awaitable version of the hyperslab write, which is performed on the
+   * I/O executor thread.
+   *
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @param data The data to write. Must stay valid until the operation
+   *     has finished.
+   * @return Awaitable operation.
+   */
   template <typename T, size_t N_DIMS>
-  void read(std::array<size_t, N_DIMS> starts,
-            std::array<size_t, N_DIMS> counts,
-            T* data) {
-    using TypeTraits = TypeProperties<T>;
-    check_type<T>();
-    detail::assert_write_mode(*file_ptr_);
-    TypeTraits::read_array(parent_id_, id_, starts.data(), counts.data(), data);
+  IOAwaitable<void> write_async(std::array<size_t, N_DIMS> starts,
+                                std::array<size_t, N_DIMS> counts,
+                                const T* data) {
+    return IOAwaitable<void>([variable = *this, starts, counts, data]() mutable {
+      variable.write(starts, counts, data);
+    });
   }
 
 
@@ -442,12 +4019,298 @@ public:
   T read() {
       using TypeTraits = TypeProperties<T>;
       check_type<T>();
+      detail::TraceSpan span("Variable::read", "read");
+      if (span) {
+        add_trace_args(span, nullptr, nullptr, sizeof(T));
+      }
       T result;
       detail::assert_write_mode(*file_ptr_);
-      TypeTraits::read_value(parent_id_, id_, 0, &result);
+      int error = instrument(CallCategory::Read, [&] {
+        return TypeTraits::read_value(parent_id_, id_, detail::zero_index, &result);
+      }, sizeof(T));
+      detail::handle_error("Error reading variable:", error);
       return result;
   }
 
+  /** Map variable data into memory.
+   *
+   * Returns a read-only view of the complete data of the variable. If
+   * the variable is stored contiguously, without filters and in native
+   * byte order, the view points directly into a memory mapping of the
+   * file, so that no data is copied and processes mapping the same
+   * file share its pages. Otherwise, or if the library was built without
+   * HDF5 support (NETCDFHPP_WITH_HDF5), the data is read into a buffer
+   * owned by the view. Data is also copied if its offset in the file is
+   * not aligned for T, see File::set_default_alignment.
+   *
+   * The mapping reflects the data in the file when map is called. Later
+   * writes to the variable aren't guaranteed to be visible through it.
+   *
+   * @tparam T The type of the variable.
+   * @return View of the variable data.
+   */
+  template <typename T>
+  VariableView<T> map() {
+    check_type<T>();
+    auto shape = current_shape();
+    size_t n = 1;
+    for (auto extent : shape) {
+      n *= extent;
+    }
+    if (auto view = map_contiguous<T>(shape, n)) {
+      return *view;
+    }
+    auto buffer = std::make_shared<std::vector<T>>(n);
+    if (n > 0) {
+      read(buffer->data());
+    }
+    return VariableView<T>(buffer, std::span<const T>(*buffer), shape, false);
+  }
+
+  /** Read variable of unknown type.
+   *
+   * Reads all data of the variable into a vector of the C++ type that
+   * corresponds to the variable's NetCDF type and calls the given visitor
+   * with it. The type is resolved once per call, so the visitor operates
+   * on data of a concrete type without any per-element branching. String
+   * variables are passed to the visitor as std::vector<std::string>.
+   *
+   * @param visitor Generic function accepting a reference to a std::vector
+   *     of any of the atomic NetCDF types.
+   * @return The value returned by the visitor.
+   */
+  template <typename Visitor>
+  decltype(auto) visit(Visitor&& visitor) {
+    return dispatch(type_, [this, &visitor](auto tag) -> decltype(auto) {
+      using T = typename decltype(tag)::type;
+      if constexpr (std::is_same_v<T, char*>) {
+        std::vector<std::string> data = read_strings();
+        return visitor(data);
+      } else {
+        std::vector<T> data(current_size());
+        read(data.data());
+        return visitor(data);
+      }
+    });
+  }
+
+  /** Read string variable.
+   *
+   * @return Vector containing all strings of the variable.
+   */
+  std::vector<std::string> read_strings() {
+    check_type<char*>();
+    std::vector<char*> data(current_size());
+    read(data.data());
+    std::vector<std::string> result;
+    result.reserve(data.size());
+    for (auto& string : data) {
+      result.push_back(string ? string : "");
+    }
+    int error = nc_free_string(data.size(), data.data());
+    detail::handle_error("Error freeing strings:", error);
+    return result;
+  }
+
+  /** Read hyperslab with type conversion.
+   *
+   * Reads data from a hyperslab of the variable and converts it to the
+   * requested type. With Conversion::Native, the data is read in the
+   * variable's own type and converted in memory, reusing the destination
+   * buffer whenever the requested type is at least as large as the variable's
+   * type. Conversion follows the semantics of static_cast. With
+   * Conversion::Library, the NetCDF-c library performs the conversion and
+   * reports values that are out of range as errors.
+   *
+   * @tparam T The type to convert the data to.
+   * @tparam N_DIM The number of dimensions of the variable.
+   * @param starts Array containing the start indices of the hyper-slab specifying
+   *     the source of the read operation.
+   * @param counts Array containing the lengths of the hyper-slab specifying the
+   *     the source of the read operation.
+   * @param data Start pointer to the destination of the read operation.
+   * @param conversion Whether to convert the data in memory or in the
+   *     NetCDF-c library.
+   */
+  template <typename T, size_t N_DIMS>
+  void read_as(std::array<size_t, N_DIMS> starts,
+               std::array<size_t, N_DIMS> counts,
+               T* data,
+               Conversion conversion = Conversion::Native) {
+    read_converted(starts.data(), counts.data(), data, conversion);
+  }
+
+  /** Read all data from variable with type conversion.
+   *
+   * @tparam T The type to convert the data to.
+   * @param data Start pointer to the destination of the read operation.
+   * @param conversion Whether to convert the data in memory or in the
+   *     NetCDF-c library.
+   */
+  template <typename T>
+  void read_as(T* data, Conversion conversion = Conversion::Native) {
+    auto counts = current_shape();
+    read_converted(detail::zero_index, counts.data(), data, conversion);
+  }
+
+  /** Read single-valued variable with type conversion.
+   *
+   * @tparam T The type to convert the value to.
+   * @return The value of the variable.
+   */
+  template <typename T>
+  T read_as() {
+    T result;
+    std::array<size_t, NC_MAX_VAR_DIMS> counts;
+    std::fill(counts.begin(), counts.end(), 1);
+    read_converted(detail::zero_index, counts.data(), &result, Conversion::Native);
+    return result;
+  }
+
+  /** Write hyperslab with type conversion.
+   *
+   * Converts the given data to the variable's type and writes it to a
+   * hyperslab of the variable. See read_as for the conversion semantics.
+   *
+   * @tparam T The type of the data to write.
+   * @tparam N_DIM The number of dimensions of the variable.
+   * @param starts Array containing the start indices of the hyper-slab specifying
+   *     the target for the write operation.
+   * @param counts Array containing the lengths of the hyper-slab specifying the
+   *     the target for the write operation.
+   * @param data Start pointer to the data to write to the variable.
+   * @param conversion Whether to convert the data in memory or in the
+   *     NetCDF-c library.
+   */
+  template <typename T, size_t N_DIMS>
+  void write_as(std::array<size_t, N_DIMS> starts,
+                std::array<size_t, N_DIMS> counts,
+                const T* data,
+                Conversion conversion = Conversion::Native) {
+    write_converted(starts.data(), counts.data(), data, conversion);
+  }
+
+  /** Write all data of variable with type conversion.
+   *
+   * @tparam T The type of the data to write.
+   * @param data Start pointer to the data to write to the variable.
+   * @param conversion Whether to convert the data in memory or in the
+   *     NetCDF-c library.
+   */
+  template <typename T>
+  void write_as(const T* data, Conversion conversion = Conversion::Native) {
+    auto counts = current_shape();
+    write_converted(detail::zero_index, counts.data(), data, conversion);
+  }
+
+  /** Read hyperslab and decode CF packing.
+   *
+   * Reads packed data from a hyperslab of the variable and decodes it in
+   * a single pass according to the CF conventions: Values are unpacked using
+   * the scale_factor and add_offset attributes, and fill values, missing
+   * values and values outside the range given by valid_range, valid_min
+   * and valid_max are replaced by NaN. The packed data is read directly
+   * into the destination buffer whenever the destination type is at least
+   * as large as the packed type.
+   *
+   * @tparam T The floating point type to decode the data to.
+   * @tparam N_DIM The number of dimensions of the variable.
+   * @param starts Array containing the start indices of the hyper-slab specifying
+   *     the source of the read operation.
+   * @param counts Array containing the lengths of the hyper-slab specifying the
+   *     the source of the read operation.
+   * @param data Start pointer to the destination of the read operation.
+   */
+  template <typename T, size_t N_DIMS>
+  void read_cf(std::array<size_t, N_DIMS> starts,
+               std::array<size_t, N_DIMS> counts,
+               T* data) {
+    read_decoded(starts.data(), counts.data(), data);
+  }
+
+  /** Read all data from variable and decode CF packing.
+   *
+   * @tparam T The floating point type to decode the data to.
+   * @param data Start pointer to the destination of the read operation.
+   */
+  template <typename T>
+  void read_cf(T* data) {
+    auto counts = current_shape();
+    read_decoded(detail::zero_index, counts.data(), data);
+  }
+
+  /** CF packing parameters of the variable.
+   *
+   * The parameters are parsed from the variable's attributes on first
+   * access and cached afterwards.
+   *
+   * @return The packing parameters used by read_cf.
+   */
+  CFPacking get_cf_packing() { return cf_packing(); }
+
+  /// Check whether variable has attribute of given name.
+  bool has_attribute(std::string name) const { return attributes_.has(name); }
+
+  /** Retrieve attribute by name.
+   *
+   * Attributes are read from the file on first access and cached
+   * afterwards.
+   *
+   * @param name Name of the attribute.
+   * @return The attribute object corresponding to the given name.
+   */
+  const Attribute& get_attribute(std::string name) const {
+    return attributes_.get(name);
+  }
+
+  /// Get vector of the names of the variable's attributes.
+  std::vector<std::string> get_attribute_names() const {
+    return attributes_.names();
+  }
+
+  /** Set attribute.
+   *
+   * Writes the attribute to the file, replacing any existing attribute
+   * of the same name.
+   *
+   * @param attribute The attribute to write.
+   */
+  void set_attribute(const Attribute& attribute) {
+    detail::assert_define_mode(*file_ptr_);
+    attributes_.set(attribute);
+  }
+
+  /** Set numeric attribute.
+   *
+   * @param name Name of the attribute.
+   * @param values The attribute values.
+   */
+  template <typename T>
+  void set_attribute(std::string name, const std::vector<T>& values) {
+    set_attribute(Attribute(name, values));
+  }
+
+  /// Set single-valued numeric attribute.
+  template <typename T>
+  void set_attribute(std::string name, T value) {
+    set_attribute(Attribute(name, std::vector<T>{value}));
+  }
+
+  /// Set text attribute.
+  void set_attribute(std::string name, std::string text) {
+    set_attribute(Attribute(name, text));
+  }
+
+  /// Set text attribute.
+  void set_attribute(std::string name, const char* text) {
+    set_attribute(Attribute(name, std::string(text)));
+  }
+
+  /// Set string attribute.
+  void set_attribute(std::string name, const std::vector<std::string>& strings) {
+    set_attribute(Attribute(name, strings));
+  }
+
   /// Return reference to dimension vector.
   const std::vector<Dimension>& get_dimensions() const { return dimensions_; }
 
@@ -478,20 +4341,472 @@ public:
     return result;
   }
 
-  /// The variable's name.
-  std::string get_name() const { return name_; }
+  /** Inquire storage options of variable.
+   *
+   * @return StorageOptions object describing the layout, chunk sizes
+   *     and filters of the variable's data in the file.
+   */
+  StorageOptions get_storage() const {
+    StorageOptions storage{};
+    int layout = 0;
+    std::vector<size_t> chunk_sizes(dimensions_.size());
+    int error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_var_chunking(parent_id_, id_, &layout, chunk_sizes.data());
+    });
+    detail::handle_error("Error inquiring variable chunking:", error);
+    storage.layout = Layout(layout);
+    if (storage.layout == Layout::Chunked) {
+      storage.chunk_sizes = chunk_sizes;
+    }
+
+    int shuffle = 0, deflate = 0, deflate_level = 0;
+    error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_var_deflate(parent_id_, id_, &shuffle, &deflate, &deflate_level);
+    });
+    detail::handle_error("Error inquiring variable compression:", error);
+    storage.shuffle = shuffle;
+    storage.deflate_level = deflate ? deflate_level : 0;
+
+    int fletcher32 = 0;
+    error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_var_fletcher32(parent_id_, id_, &fletcher32);
+    });
+    detail::handle_error("Error inquiring variable checksum:", error);
+    storage.fletcher32 = fletcher32;
+
+    int no_fill = 0;
+    error = instrument(CallCategory::Inquire, [&] {
+      return nc_inq_var_fill(parent_id_, id_, &no_fill, nullptr);
+    });
+    detail::handle_error("Error inquiring variable fill mode:", error);
+    storage.fill_mode = no_fill ? FillMode::NoFill : FillMode::Fill;
+    return storage;
+  }
+
+  /** Set chunk cache of variable.
+   *
+   * @param cache The chunk cache settings to apply to the variable.
+   */
+  void set_chunk_cache(const ChunkCache& cache) {
+    int error = instrument(CallCategory::Cache, [&] {
+      return nc_set_var_chunk_cache(
+          parent_id_, id_, cache.size, cache.n_elements, cache.preemption);
+    });
+    detail::handle_error("Error setting variable chunk cache:", error);
+  }
+
+  /// The chunk cache settings of the variable.
+  ChunkCache get_chunk_cache() const {
+    ChunkCache cache{};
+    int error = instrument(CallCategory::Inquire, [&] {
+      return nc_get_var_chunk_cache(
+          parent_id_, id_, &cache.size, &cache.n_elements, &cache.preemption);
+    });
+    detail::handle_error("Error inquiring variable chunk cache:", error);
+    return cache;
+  }
+
+  /** Fit chunk cache to hyperslab.
+   *
+   * Grows the variable's chunk cache so that it can hold all chunks
+   * touched by the given hyperslab, which avoids repeated decompression
+   * of chunks during the read. The cache is never shrunk. Has no effect
+   * on variables that are not chunked.
+   *
+   * @param starts Array containing the start indices of the hyperslab.
+   * @param counts Array containing the lengths of the hyperslab.
+   * @param max_size Upper limit for the size of the cache in bytes.
+   * @return The resulting chunk cache settings.
+   */
+  template <size_t N_DIMS>
+  ChunkCache fit_chunk_cache(std::array<size_t, N_DIMS> starts,
+                             std::array<size_t, N_DIMS> counts,
+                             size_t max_size = size_t(1) << 30) {
+    if (N_DIMS != dimensions_.size()) {
+      throw std::runtime_error("Hyperslab rank does not match variable rank.");
+    }
+    return fit_chunk_cache(starts.data(), counts.data(), max_size);
+  }
+
+  /** Set chunk cache policy of variable.
+   *
+   * With ChunkCachePolicy::Auto, the chunk cache is fitted to every
+   * hyperslab read whose shape differs from the previous one.
+   *
+   * @param policy The chunk cache policy to use.
+   */
+  void set_chunk_cache_policy(ChunkCachePolicy policy) {
+    chunk_cache_policy_ = policy;
+    fitted_counts_.clear();
+  }
+
+  /// The variable's name.
+  std::string get_name() const { return name_; }
+
+  /// The NetCDF type of the variable.
+  Type get_type() const { return type_; }
+
+  /// The variable ID used by the NetCDF-c library.
+  int get_id() const { return id_; }
+
+  /// The ID of the group that contains the variable.
+  int get_parent_id() const { return parent_id_; }
+
+  /** I/O statistics of the variable.
+   *
+   * @return Snapshot of the statistics of all library calls issued on
+   *     this variable since the file was opened or the statistics were
+   *     last reset. Empty unless NETCDFHPP_INSTRUMENTATION is defined.
+   */
+  IOStats get_io_stats() const {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    return file_ptr_->stats.get_variable_stats(parent_id_, id_);
+#else
+    return {};
+#endif
+  }
+
+  /// Reset the I/O statistics of the variable.
+  void reset_io_stats() {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    file_ptr_->stats.reset_variable(parent_id_, id_);
+#endif
+  }
+
+ private:
+  int id_, parent_id_;
+  std::vector<Dimension> dimensions_;
+  char name_[NC_MAX_NAME + 1] = {0};
+  Type type_ = Type::NotAType;
+  std::shared_ptr<detail::FileID> file_ptr_ = nullptr;
+  ChunkCachePolicy chunk_cache_policy_ = ChunkCachePolicy::Manual;
+  std::vector<size_t> fitted_counts_ = {};
+  detail::Attributes attributes_ = {};
+  std::shared_ptr<const CFPacking> cf_packing_ = nullptr;
+  size_t cf_packing_version_ = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Record appender
+////////////////////////////////////////////////////////////////////////////////
+/** Buffered appender for records of a variable.
+ *
+ * Appends records, i.e. slices along the unlimited first dimension, to
+ * a variable. Records are collected in memory and written in a single
+ * library call once they fill a block of records that is aligned with
+ * the chunks of the variable along the unlimited dimension. This avoids
+ * the many small writes and repeated chunk rewrites that result from
+ * writing records one by one.
+ *
+ * Buffered records are written when flush() is called and when the
+ * appender is destroyed. Errors during the latter are ignored, so
+ * flush() should be called explicitly where they matter.
+ *
+ * @tparam T The C++ type of the record data. Converted to the type of
+ *     the variable if required.
+ */
+template <typename T>
+class RecordAppender {
+ public:
+  /** Create appender for variable.
+   *
+   * Appending starts after the current last record along the unlimited
+   * dimension of the variable.
+   *
+   * @param variable The variable to append to. Its first dimension must
+   *     be unlimited.
+   * @param capacity The number of records to buffer. Rounded up to a
+   *     multiple of the chunk size along the unlimited dimension.
+   *     Defaults to a single chunk.
+   * @throw std::runtime_error if the first dimension of the variable
+   *     isn't unlimited or if its records are empty, which is the case
+   *     when any other dimension currently has length zero.
+   */
+  RecordAppender(Variable variable, size_t capacity = 0)
+      : variable_(variable) {
+    auto& dimensions = variable_.dimensions_;
+    if (dimensions.empty() ||
+        !detail::is_unlimited(
+            *variable_.file_ptr_, variable_.parent_id_, dimensions[0].id)) {
+      throw std::runtime_error(
+          "Records can only be appended to variables with an unlimited "
+          "first dimension.");
+    }
+    // The cached dimension sizes may be outdated, so the record shape is
+    // taken from the current dimension lengths.
+    record_shape_.resize(dimensions.size() - 1);
+    for (size_t i = 1; i < dimensions.size(); ++i) {
+      int error = variable_.instrument(CallCategory::Inquire, [&] {
+        return nc_inq_dimlen(
+            variable_.parent_id_, dimensions[i].id, &record_shape_[i - 1]);
+      });
+      detail::handle_error("Error inquiring dimension length:", error);
+      record_size_ *= record_shape_[i - 1];
+    }
+    if (record_size_ == 0) {
+      throw std::runtime_error(
+          "Records can only be appended to variables whose dimensions other "
+          "than the first have non-zero length.");
+    }
+
+    auto storage = variable_.get_storage();
+    size_t chunk_size = 1;
+    if (storage.layout == Layout::Chunked) {
+      chunk_size = std::max<size_t>(storage.chunk_sizes[0], 1);
+    }
+    capacity_ = std::max(capacity, chunk_size);
+    capacity_ = ((capacity_ + chunk_size - 1) / chunk_size) * chunk_size;
+
+    int error = variable_.instrument(CallCategory::Inquire, [&] {
+      return nc_inq_dimlen(variable_.parent_id_, dimensions[0].id, &n_records_);
+    });
+    detail::handle_error("Error inquiring number of records:", error);
+    buffer_.reserve(capacity_ * record_size_);
+  }
+
+  RecordAppender(const RecordAppender&) = delete;
+  RecordAppender& operator=(const RecordAppender&) = delete;
+  RecordAppender(RecordAppender&&) = default;
+
+  ~RecordAppender() {
+    try {
+      flush();
+    } catch (...) {
+    }
+  }
+
+  /** Append record.
+   *
+   * @param record Pointer to the record_size() elements of the record.
+   */
+  void append(const T* record) { append(record, 1); }
+
+  /** Append multiple records.
+   *
+   * @param records Pointer to the contiguous data of the records.
+   * @param n_records The number of records to append.
+   */
+  void append(const T* records, size_t n_records) {
+    while (n_records > 0) {
+      size_t n = std::min(n_records, block_end() - size());
+      buffer_.insert(buffer_.end(), records, records + n * record_size_);
+      records += n * record_size_;
+      n_records -= n;
+      if (size() == block_end()) {
+        flush();
+      }
+    }
+  }
+
+  /** Write buffered records to the variable.
+   *
+   * Grows the unlimited dimension to hold the buffered records.
+   */
+  void flush() {
+    size_t n = n_buffered();
+    if (n == 0) {
+      return;
+    }
+    std::vector<size_t> starts(variable_.dimensions_.size(), 0);
+    std::vector<size_t> counts(variable_.dimensions_.size(), 0);
+    starts[0] = n_records_;
+    counts[0] = n;
+    for (size_t i = 1; i < counts.size(); ++i) {
+      counts[i] = record_shape_[i - 1];
+    }
+    variable_.write_converted(
+        starts.data(), counts.data(), buffer_.data(), Conversion::Native);
+    n_records_ += n;
+    buffer_.clear();
+  }
+
+  /// The number of records of the variable including buffered records.
+  size_t size() const { return n_records_ + n_buffered(); }
+
+  /// The number of records that haven't been written yet.
+  size_t n_buffered() const { return buffer_.size() / record_size_; }
+
+  /// The number of elements in a record.
+  size_t record_size() const { return record_size_; }
+
+  /// The number of records that are buffered before they are written.
+  size_t get_capacity() const { return capacity_; }
+
+ private:
+  // Index of the record that ends the current block.
+  size_t block_end() const { return (n_records_ / capacity_ + 1) * capacity_; }
+
+  Variable variable_;
+  std::vector<size_t> record_shape_ = {};
+  size_t record_size_ = 1;
+  size_t capacity_ = 1;
+  size_t n_records_ = 0;
+  std::vector<T> buffer_ = {};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Record reader
+////////////////////////////////////////////////////////////////////////////////
+
+/** Sequential read-ahead reader of records.
+ *
+ * Iterates over the records of a variable along a given dimension, by
+ * default the first, which is usually the unlimited dimension. While a
+ * record is processed, the following records are read on the I/O
+ * executor thread into a ring of reusable buffers, so that reading and
+ * decompressing the data overlaps with the processing.
+ *
+ * A record remains valid until the next record is requested. While
+ * the reader is in use, the file must not be accessed from other
+ * threads except through the I/O executor. Readers that are used on
+ * the I/O executor thread itself, for example within a request of an
+ * AsyncFile, read each record synchronously when it is prefetched.
+ *
+ * @tparam T The C++ type of the record data. The data is converted
+ *     from the type of the variable if required.
+ */
+template <typename T>
+class RecordReader {
+  // Buffer of the ring and the pending read into it.
+  struct Slot {
+    std::vector<T> data = {};
+    std::future<void> ready = {};
+  };
+
+ public:
+  /** Create reader.
+   *
+   * @param variable The variable to read.
+   * @param n_prefetch The number of records to read ahead.
+   * @param dimension Index of the dimension along which to iterate.
+   * @throw std::runtime_error if the variable has no dimension with the
+   *     given index.
+   */
+  RecordReader(Variable variable, size_t n_prefetch = 2, size_t dimension = 0)
+      : variable_(variable),
+        dimension_(dimension),
+        n_prefetch_(std::max<size_t>(n_prefetch, 1)) {
+    shape_ = variable_.current_shape();
+    if (dimension_ >= shape_.size()) {
+      throw std::runtime_error("Variable " + std::string(variable_.name_) +
+                               " has no dimension with index " +
+                               std::to_string(dimension_) + ".");
+    }
+    n_records_ = shape_[dimension_];
+    shape_[dimension_] = 1;
+    record_size_ = detail::n_elements(shape_);
+    slots_.resize(n_prefetch_ + 1);
+    for (auto& slot : slots_) {
+      slot.data.resize(record_size_);
+    }
+    for (size_t i = 0; i < std::min(n_prefetch_, n_records_); ++i) {
+      prefetch(i);
+    }
+  }
+
+  RecordReader(const RecordReader&) = delete;
+  RecordReader& operator=(const RecordReader&) = delete;
+
+  /// Waits for pending reads.
+  ~RecordReader() {
+    for (auto& slot : slots_) {
+      if (slot.ready.valid()) {
+        slot.ready.wait();
+      }
+    }
+  }
+
+  /** Retrieve next record.
+   *
+   * Waits until the record has been read and starts reading ahead the
+   * record that follows the prefetched ones.
+   *
+   * @return The data of the record in row-major order or an empty span
+   *     if all records have been read.
+   */
+  std::span<const T> next() {
+    if (position_ >= n_records_) {
+      return {};
+    }
+    Slot& slot = slots_[position_ % slots_.size()];
+    slot.ready.get();
+    // The slot of the previous record is free now.
+    if (position_ + n_prefetch_ < n_records_) {
+      prefetch(position_ + n_prefetch_);
+    }
+    ++position_;
+    return slot.data;
+  }
+
+  /// Input iterator over the records.
+  class iterator {
+   public:
+    using value_type = std::span<const T>;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    explicit iterator(RecordReader* reader) : reader_(reader) { ++*this; }
+
+    const std::span<const T>& operator*() const { return record_; }
+    iterator& operator++() {
+      if (reader_->position_ >= reader_->n_records_) {
+        reader_ = nullptr;
+      } else {
+        record_ = reader_->next();
+      }
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    bool operator==(std::default_sentinel_t) const { return reader_ == nullptr; }
+
+   private:
+    RecordReader* reader_ = nullptr;
+    std::span<const T> record_ = {};
+  };
+
+  /// Iterator starting at the next record.
+  iterator begin() { return iterator(this); }
+  std::default_sentinel_t end() { return {}; }
+
+  /// The number of records.
+  size_t size() const { return n_records_; }
+
+  /// The index of the next record.
+  size_t position() const { return position_; }
+
+  /// The number of elements in a record.
+  size_t record_size() const { return record_size_; }
+
+  /// The shape of a record, which has extent 1 along the iterated dimension.
+  const std::vector<size_t>& record_shape() const { return shape_; }
 
  private:
-  int id_, parent_id_;
-  std::vector<Dimension> dimensions_;
-  char name_[NC_MAX_NAME + 1] = {0};
-  Type type_ = Type::NotAType;
-  std::shared_ptr<detail::FileID> file_ptr_ = nullptr;
+  // Starts reading the given record into its slot.
+  void prefetch(size_t index) {
+    Slot& slot = slots_[index % slots_.size()];
+    std::vector<size_t> starts(shape_.size(), 0);
+    starts[dimension_] = index;
+    slot.ready = detail::IOExecutor::get().submit(
+        [this, starts = std::move(starts), data = slot.data.data()] {
+          variable_.read_converted(starts.data(), shape_.data(), data, Conversion::Native);
+        });
+  }
+
+  Variable variable_;
+  size_t dimension_;
+  size_t n_prefetch_;
+  std::vector<size_t> shape_ = {};
+  size_t n_records_ = 0;
+  size_t record_size_ = 1;
+  size_t position_ = 0;
+  std::vector<Slot> slots_ = {};
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 // NetCDF Group
 ////////////////////////////////////////////////////////////////////////////////
+class DefineTransaction;
+
 /** A NetCDF group.
   *
   * A NetCDF group contains dimensions, variables, attributes
@@ -499,104 +4814,207 @@ public:
   *
   */
 class Group {
+  friend class DefineTransaction;
+
  private:
 
   // Parses dimensions in this group.
   void parse_dimensions() {
-    auto dim_ids = std::make_unique<int[]>(n_dims_);
-    int error = nc_inq_dimids(id_, 0, dim_ids.get(), 0);
+    if (dimensions_parsed_ || !file_ptr_->open) {
+      return;
+    }
+    detail::TraceSpan span("Group::parse_dimensions", "metadata");
+    if (span) {
+      span.add_arg("group", name_);
+    }
+    int n_dims = 0;
+    int error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+      return nc_inq_dimids(id_, &n_dims, 0, 0);
+    });
+    detail::handle_error("Error inquiring number of dimensions:", error);
+    auto dim_ids = std::make_unique<int[]>(n_dims);
+    error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+      return nc_inq_dimids(id_, 0, dim_ids.get(), 0);
+    });
     detail::handle_error("Error inquiring dimension IDs:", error);
-    for (int i = 0; i < n_dims_; ++i) {
+    for (int i = 0; i < n_dims; ++i) {
       int dim_id = dim_ids[i];
       Dimension dim{dim_id};
-      error = nc_inq_dim(id_, dim_id, dim.name, &dim.size);
+      error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+        return nc_inq_dim(id_, dim_id, dim.name, &dim.size);
+      });
       detail::handle_error("Error inquiring dimensions", error);
       dimensions_[dim.name] = dim;
     }
 
-    dim_ids = std::make_unique<int[]>(n_unl_dims_);
-    error = nc_inq_unlimdims(id_, 0, dim_ids.get());
+    int n_unl_dims = 0;
+    error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+      return nc_inq_unlimdims(id_, &n_unl_dims, 0);
+    });
+    detail::handle_error("Error inquiring number of unlimited dimensions:",
+                         error);
+    dim_ids = std::make_unique<int[]>(n_unl_dims);
+    error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+      return nc_inq_unlimdims(id_, 0, dim_ids.get());
+    });
     detail::handle_error("Error inquiring unlimited dimension IDs:", error);
-    for (int i = 0; i < n_unl_dims_; ++i) {
+    for (int i = 0; i < n_unl_dims; ++i) {
       int dim_id = dim_ids[i];
       Dimension dim{dim_id};
       dim.unlimited = true;
       dim.size = -1;
-      error = nc_inq_dim(id_, dim_id, dim.name, &dim.size);
+      error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+        return nc_inq_dim(id_, dim_id, dim.name, &dim.size);
+      });
       detail::handle_error("Error inquiring dimensions", error);
       dimensions_[dim.name] = dim;
     }
+    dimensions_parsed_ = true;
   }
 
   // Parses variables in this group.
   void parse_variables() {
-    auto var_ids = std::make_unique<int[]>(n_vars_);
-    int error = nc_inq_varids(id_, 0, var_ids.get());
+    if (variables_parsed_ || !file_ptr_->open) {
+      return;
+    }
+    detail::TraceSpan span("Group::parse_variables", "metadata");
+    if (span) {
+      span.add_arg("group", name_);
+    }
+    int n_vars = 0;
+    int error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+      return nc_inq_varids(id_, &n_vars, 0);
+    });
+    detail::handle_error("Error inquiring number of variables:", error);
+    auto var_ids = std::make_unique<int[]>(n_vars);
+    error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+      return nc_inq_varids(id_, 0, var_ids.get());
+    });
     detail::handle_error("Error inquiring variable IDs:", error);
-    for (int i = 0; i < n_vars_; ++i) {
+    for (int i = 0; i < n_vars; ++i) {
       int var_id = var_ids[i];
       Variable var{file_ptr_, id_, var_id};
       variables_[var.get_name()] = var;
     }
+    variables_parsed_ = true;
   }
 
     // Parses sub-groups of this group
     void parse_groups() {
-        auto group_ids = std::make_unique<int[]>(n_groups_);
-        int error = nc_inq_grps(id_, 0, group_ids.get());
+        if (groups_parsed_ || !file_ptr_->open) {
+            return;
+        }
+        detail::TraceSpan span("Group::parse_groups", "metadata");
+        if (span) {
+            span.add_arg("group", name_);
+        }
+        int n_groups = 0;
+        int error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+          return nc_inq_grps(id_, &n_groups, 0);
+        });
+        detail::handle_error("Error inquiring number of groups:", error);
+        auto group_ids = std::make_unique<int[]>(n_groups);
+        error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+          return nc_inq_grps(id_, 0, group_ids.get());
+        });
         detail::handle_error("Error inquiring group IDs:", error);
-        for (int i = 0; i < n_groups_; ++i) {
+        for (int i = 0; i < n_groups; ++i) {
             int group_id = group_ids[i];
             size_t name_length = 0;
-            error = nc_inq_grpname_len(group_id, &name_length);
+            error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+              return nc_inq_grpname_len(group_id, &name_length);
+            });
             detail::handle_error("Error inquiring group name length:", error);
-            auto name_bfr = std::make_unique<char[]>(name_length);
-            error = nc_inq_grpname(group_id, name_bfr.get());
+            auto name_bfr = std::make_unique<char[]>(name_length + 1);
+            error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+              return nc_inq_grpname(group_id, name_bfr.get());
+            });
             detail::handle_error("Error inquiring group name:", error);
 
-            Group group{file_ptr_, group_id, name_bfr.get()};
-            groups_[group.get_name()] = group;
+            std::string name = name_bfr.get();
+            if (groups_.find(name) == groups_.end()) {
+                groups_[name] = Group{file_ptr_, group_id, name};
+            }
         }
+        groups_parsed_ = true;
+    }
+
+  // Looks up variable by name, resolving it from the file if it
+  // hasn't been accessed before. Returns nullptr if the group has
+  // no variable of the given name.
+  Variable* find_variable(const std::string& name) {
+    auto found = variables_.find(name);
+    if (found != variables_.end()) {
+      return &found->second;
     }
+    if (variables_parsed_ || !file_ptr_->open) {
+      return nullptr;
+    }
+    int var_id = 0;
+    int error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+      return nc_inq_varid(id_, name.c_str(), &var_id);
+    });
+    if (error == NC_ENOTVAR) {
+      return nullptr;
+    }
+    detail::handle_error("Error inquiring variable ID:", error);
+    auto inserted = variables_.emplace(name, Variable{file_ptr_, id_, var_id});
+    return &inserted.first->second;
+  }
+
+  // Looks up sub-group by name, resolving it from the file if it
+  // hasn't been accessed before. Returns nullptr if the group has
+  // no sub-group of the given name.
+  Group* find_group(const std::string& name) {
+    auto found = groups_.find(name);
+    if (found != groups_.end()) {
+      return &found->second;
+    }
+    if (groups_parsed_ || !file_ptr_->open) {
+      return nullptr;
+    }
+    int group_id = 0;
+    int error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+      return nc_inq_grp_ncid(id_, name.c_str(), &group_id);
+    });
+    if (error == NC_ENOGRP) {
+      return nullptr;
+    }
+    detail::handle_error("Error inquiring group ID:", error);
+    auto inserted = groups_.emplace(name, Group{file_ptr_, group_id, name});
+    return &inserted.first->second;
+  }
 
   // Ensure that file is in define mode.
-  void assert_define_mode() { detail::assert_define_mode(id_); }
+  void assert_define_mode() { detail::assert_define_mode(*file_ptr_); }
 
   // Ensure that file in write mode.
-  void assert_write_mode() { detail::assert_write_mode(id_); }
+  void assert_write_mode() { detail::assert_write_mode(*file_ptr_); }
 
 public:
 
     Group() {}
   /** Create new group.
     *
-    * Creates a new group and parses its dimensions, variables and attributes.
+    * Creates a new group. Dimensions, variables and sub-groups are resolved
+    * lazily when they are first accessed, unless the file was opened with
+    * ParseMode::Eager, in which case the complete group tree is parsed
+    * immediately.
     *
     * @param file_ptr Shared pointer to FileID object managing the NetCDF file.
     * @param id The group ID that identifies the group in the NetCDF-c library.
     * @param name The name of the group.
     */
   Group(std::shared_ptr<detail::FileID> file_ptr, int id, std::string name)
-      : file_ptr_(file_ptr), id_(id), name_(name) {
-    //
-    // Inquire number of dimensions, variables, attributes and groups.
-    //
-    int error = nc_inq_dimids(id_, &n_dims_, 0, 0);
-    detail::handle_error("Error inquiring number of dimensions:", error);
-    error = nc_inq_unlimdims(id_, &n_unl_dims_, 0);
-    detail::handle_error("Error inquiring number of unlimited dimensions:",
-                         error);
-    error = nc_inq_varids(id_, &n_vars_, 0);
-    detail::handle_error("Error inquiring number of variables:", error);
-    error = nc_inq_natts(id_, &n_attrs_);
-    detail::handle_error("Error inquiring number of attributes:", error);
-    error = nc_inq_grps(id_, &n_groups_, 0);
-    detail::handle_error("Error inquiring number of groups:", error);
-
-    parse_dimensions();
-    parse_variables();
-    parse_groups();
-    //parse_attributes();
+      : file_ptr_(file_ptr),
+        id_(id),
+        name_(name),
+        attributes_(*file_ptr, id, NC_GLOBAL) {
+    if (file_ptr_->eager_parsing) {
+      parse_dimensions();
+      parse_variables();
+      parse_groups();
+    }
   }
 
   /** Add dimension to group.
@@ -608,7 +5026,9 @@ public:
   Dimension add_dimension(std::string name, int size) {
     assert_define_mode();
     Dimension dim{name, size};
-    int error = nc_def_dim(id_, name.c_str(), size, &dim.id);
+    int error = file_ptr_->instrument(CallCategory::Define, [&] {
+      return nc_def_dim(id_, name.c_str(), size, &dim.id);
+    });
     detail::handle_error("Error creating dimensions: ", error);
     dimensions_[name] = dim;
     sync();
@@ -624,7 +5044,9 @@ public:
     assert_define_mode();
     Dimension dim{name, -1};
     dim.unlimited = true;
-    int error = nc_def_dim(id_, name.c_str(), NC_UNLIMITED, &dim.id);
+    int error = file_ptr_->instrument(CallCategory::Define, [&] {
+      return nc_def_dim(id_, name.c_str(), NC_UNLIMITED, &dim.id);
+    });
     detail::handle_error("Error creating dimensions: ", error);
     sync();
     dimensions_[name] = dim;
@@ -639,16 +5061,36 @@ public:
   Group add_group(std::string name) {
     assert_define_mode();
     int group_id = 0;
-    int error = nc_def_grp(id_, name.c_str(), &group_id);
+    int error = file_ptr_->instrument(CallCategory::Define, [&] {
+      return nc_def_grp(id_, name.c_str(), &group_id);
+    });
     detail::handle_error("Error creating group: ", error);
     sync();
     groups_[name] = Group(file_ptr_, group_id, name);
     return groups_[name];
   }
 
+  /** Start define transaction.
+    *
+    * Definitions added to the returned transaction are created in a single
+    * define-mode session when the transaction is committed.
+    *
+    * @return A new define transaction for this group.
+    */
+  DefineTransaction define();
+
   void sync() {
+    if (file_ptr_->read_only) {
+      return;
+    }
+    detail::TraceSpan span("Group::sync", "sync");
+    if (span) {
+      span.add_arg("group", name_);
+    }
     assert_write_mode();
-    int error = nc_sync(id_);
+    int error = file_ptr_->instrument(CallCategory::Sync, [&] {
+      return nc_sync(id_);
+    });
     detail::handle_error("Error entering define mode: ", error);
   }
 
@@ -658,11 +5100,15 @@ public:
     * @param dimension Vector of dimension names identifying the dimensions
     *    of the variable.
     * @type Type enumer specifying the variable type.
+    * @param storage Storage options defining layout, chunking and filters
+    *    of the variable.
     * @return Variable object representing the newly created variable
     */
   Variable add_variable(std::string name,
                         std::vector<std::string> dimensions,
-                        Type type) {
+                        Type type,
+                        const StorageOptions& storage = {}) {
+    parse_dimensions();
     assert_define_mode();
     int n_dims = dimensions.size();
     std::vector<int> dim_ids;
@@ -675,27 +5121,67 @@ public:
         msg << "Dimension " << d << " is not defined.";
         throw std::runtime_error(msg.str());
       }
-      dim_ids[i] = search->second.id;
+      dim_ids.push_back(search->second.id);
     }
     int var_id = 0;
-    int error = nc_def_var(id_,
-                           name.c_str(),
-                           static_cast<int>(type),
-                           n_dims,
-                           dim_ids.data(),
-                           &var_id);
+    int error = file_ptr_->instrument(CallCategory::Define, [&] {
+      return nc_def_var(id_,
+                        name.c_str(),
+                        static_cast<int>(type),
+                        n_dims,
+                        dim_ids.data(),
+                        &var_id);
+    });
     detail::handle_error("Error defining variable:", error);
+    detail::define_storage(*file_ptr_, id_, var_id, storage);
     sync();
     variables_[name] = Variable(file_ptr_, id_, var_id);
     return variables_[name];
   }
 
+  /** Inspect chunk shape of a new variable.
+    *
+    * Returns the chunk shape that add_variable would choose for a variable
+    * with the given dimensions, type and storage options together with
+    * an explanation of the choice.
+    *
+    * @param dimensions Vector of dimension names identifying the dimensions
+    *    of the variable.
+    * @param type The type of the variable.
+    * @param storage Storage options of the variable.
+    * @return The chunk shape.
+    */
+  ChunkPlan plan_chunks(std::vector<std::string> dimensions,
+                        Type type,
+                        const StorageOptions& storage = {}) {
+    parse_dimensions();
+    std::vector<size_t> shape;
+    std::vector<bool> unlimited;
+    for (auto& d : dimensions) {
+      auto search = dimensions_.find(d);
+      if (search == dimensions_.end()) {
+        std::stringstream msg;
+        msg << "Dimension " << d << " is not defined.";
+        throw std::runtime_error(msg.str());
+      }
+      shape.push_back(search->second.size);
+      unlimited.push_back(search->second.unlimited);
+    }
+    size_t element_size = 0;
+    int error = file_ptr_->instrument(CallCategory::Inquire, [&] {
+      return nc_inq_type(id_, static_cast<int>(type), nullptr, &element_size);
+    });
+    detail::handle_error("Error inquiring type size:", error);
+    return netcdf4::plan_chunks(shape, unlimited, element_size, storage);
+  }
+
   /** Retrieve dimension by name.
     *
     * @param name Name of the dimension.
     * @return The dimensions object corresponding to the given name.
     */
   Dimension get_dimension(std::string name) {
+    parse_dimensions();
     auto found = dimensions_.find(name);
     if (found != dimensions_.end()) {
       return found->second;
@@ -711,9 +5197,9 @@ public:
     * @return The variable object corresponding to the given name.
     */
   Variable get_variable(std::string name) {
-    auto found = variables_.find(name);
-    if (found != variables_.end()) {
-      return found->second;
+    auto found = find_variable(name);
+    if (found) {
+      return *found;
     }
     std::stringstream msg;
     msg << "Variable " << name << " not found in variables.";
@@ -721,23 +5207,23 @@ public:
   }
 
   /// Check whether group has variable of given name.
-  bool has_variable(std::string name) {
-    auto found = variables_.find(name);
-    return found != variables_.end();
-  }
+  bool has_variable(std::string name) { return find_variable(name) != nullptr; }
 
   /// The group name.
   std::string get_name() const { return name_; }
 
+  /// The group ID used by the NetCDF-c library.
+  int get_id() const { return id_; }
+
   /** Retrieve group by name.
     *
     * @param name Name of the group.
     * @return The group object corresponding to the given name.
     */
   Group get_group(std::string name) {
-      auto found = groups_.find(name);
-      if (found != groups_.end()) {
-          return found->second;
+      auto found = find_group(name);
+      if (found) {
+          return *found;
       }
       std::stringstream msg;
       msg << "Group " << name << " not found in variables.";
@@ -748,28 +5234,639 @@ public:
      * @return Vector containing the names this group's subgroups.
      */
   std::vector<std::string> get_group_names() {
+    parse_groups();
     std::vector<std::string> names{};
     names.reserve(groups_.size());
     for (auto& pair : groups_) {
       names.push_back(pair.second.get_name());
     }
-    return names;
+    return names;
+  }
+
+  /// Check whether group has attribute of given name.
+  bool has_attribute(std::string name) const { return attributes_.has(name); }
+
+  /** Retrieve attribute by name.
+   *
+   * Attributes are read from the file on first access and cached
+   * afterwards.
+   *
+   * @param name Name of the attribute.
+   * @return The attribute object corresponding to the given name.
+   */
+  const Attribute& get_attribute(std::string name) const {
+    return attributes_.get(name);
+  }
+
+  /// Get vector of the names of the group's attributes.
+  std::vector<std::string> get_attribute_names() const {
+    return attributes_.names();
+  }
+
+  /** Set attribute.
+   *
+   * Writes the attribute to the file, replacing any existing attribute
+   * of the same name.
+   *
+   * @param attribute The attribute to write.
+   */
+  void set_attribute(const Attribute& attribute) {
+    assert_define_mode();
+    attributes_.set(attribute);
+  }
+
+  /** Set numeric attribute.
+   *
+   * @param name Name of the attribute.
+   * @param values The attribute values.
+   */
+  template <typename T>
+  void set_attribute(std::string name, const std::vector<T>& values) {
+    set_attribute(Attribute(name, values));
+  }
+
+  /// Set single-valued numeric attribute.
+  template <typename T>
+  void set_attribute(std::string name, T value) {
+    set_attribute(Attribute(name, std::vector<T>{value}));
+  }
+
+  /// Set text attribute.
+  void set_attribute(std::string name, std::string text) {
+    set_attribute(Attribute(name, text));
+  }
+
+  /// Set text attribute.
+  void set_attribute(std::string name, const char* text) {
+    set_attribute(Attribute(name, std::string(text)));
+  }
+
+  /// Set string attribute.
+  void set_attribute(std::string name, const std::vector<std::string>& strings) {
+    set_attribute(Attribute(name, strings));
+  }
+
+  /// Check whether group has subgroup of given name.
+  bool has_group(std::string name) { return find_group(name) != nullptr; }
+
+ protected:
+  std::shared_ptr<detail::FileID> file_ptr_;
+  int id_;
+  std::string name_;
+  bool dimensions_parsed_ = false;
+  bool variables_parsed_ = false;
+  bool groups_parsed_ = false;
+  std::map<std::string, Dimension> dimensions_ = {};
+  std::map<std::string, Variable> variables_ = {};
+  std::map<std::string, Group> groups_ = {};
+  detail::Attributes attributes_ = {};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Define transaction
+////////////////////////////////////////////////////////////////////////////////
+/** Batched definition of group contents.
+ *
+ * A define transaction collects dimension, variable, group and attribute
+ * definitions without issuing any calls to the NetCDF-c library. On commit,
+ * all definitions are created in a single define-mode session, after which
+ * the file leaves define mode once. This avoids the mode switches and file
+ * synchronization that the Group::add_* methods perform after every single
+ * definition.
+ *
+ * Definitions that have not been committed when the transaction is
+ * destroyed are discarded.
+ */
+class DefineTransaction {
+  // A pending dimension definition.
+  struct DimensionDefinition {
+    std::string name;
+    size_t size;
+    bool unlimited;
+  };
+
+  // A pending variable definition.
+  struct VariableDefinition {
+    std::string name;
+    std::vector<std::string> dimensions;
+    Type type;
+    StorageOptions storage;
+  };
+
+  // A pending attribute definition. An empty variable name designates a
+  // group attribute.
+  struct AttributeDefinition {
+    std::string variable;
+    Attribute attribute;
+  };
+
+  // Creates a transaction for a group that is defined by the parent
+  // transaction.
+  DefineTransaction(DefineTransaction* parent, std::string name)
+      : parent_(parent), name_(name) {}
+
+  // Look up dimension ID from definitions in this or parent transactions,
+  // or in the group this transaction belongs to.
+  int find_dimension_id(const std::string& name) const;
+
+  // Whether a dimension is defined in this or a parent transaction, or in
+  // the group this transaction belongs to.
+  bool has_dimension(const std::string& name) const;
+
+  // Check all pending definitions for duplicate names and references to
+  // undefined dimensions or variables. Throws std::runtime_error without
+  // touching the file if a definition is invalid.
+  void validate() const;
+
+  // The file in which the definitions are created.
+  detail::FileID& file() const;
+
+  // Issue all pending definitions to the NetCDF-c library. Must be called
+  // in define mode.
+  void define(int group_id);
+
+
+ public:
+  /** Create transaction for group.
+   *
+   * @param group The group in which to create the definitions. The group
+   *     must outlive the transaction.
+   */
+  DefineTransaction(Group& group) : group_(&group) {}
+
+  DefineTransaction(const DefineTransaction&) = delete;
+  DefineTransaction& operator=(const DefineTransaction&) = delete;
+  DefineTransaction& operator=(DefineTransaction&&) = delete;
+
+  /** Move transaction.
+   *
+   * Transactions of sub-groups refer to their parent, so they are
+   * re-attached to the new transaction.
+   */
+  DefineTransaction(DefineTransaction&& other)
+      : group_(other.group_),
+        parent_(other.parent_),
+        name_(std::move(other.name_)),
+        group_id_(other.group_id_),
+        committed_(other.committed_),
+        dimensions_(std::move(other.dimensions_)),
+        variables_(std::move(other.variables_)),
+        attributes_(std::move(other.attributes_)),
+        groups_(std::move(other.groups_)),
+        dimension_ids_(std::move(other.dimension_ids_)),
+        variable_ids_(std::move(other.variable_ids_)) {
+    for (auto& g : groups_) {
+      g->parent_ = this;
+    }
+  }
+
+  /** Add dimension to transaction.
+   *
+   * @param name Name of the dimension.
+   * @param size The dimension's size.
+   * @return Reference to this transaction.
+   */
+  DefineTransaction& add_dimension(std::string name, int size) {
+    dimensions_.push_back({name, static_cast<size_t>(size), false});
+    return *this;
+  }
+
+  /** Add unlimited dimension to transaction.
+   *
+   * @param name Name of the dimension.
+   * @return Reference to this transaction.
+   */
+  DefineTransaction& add_dimension(std::string name) {
+    dimensions_.push_back({name, NC_UNLIMITED, true});
+    return *this;
+  }
+
+  /** Add variable to transaction.
+   *
+   * @param name Name of the variable.
+   * @param dimensions Vector of dimension names identifying the dimensions
+   *     of the variable. The dimensions may be defined in the same
+   *     transaction or in any enclosing transaction.
+   * @param type Type enum specifying the variable type.
+   * @param storage Storage options defining layout, chunking and filters
+   *     of the variable.
+   * @return Reference to this transaction.
+   */
+  DefineTransaction& add_variable(std::string name,
+                                  std::vector<std::string> dimensions,
+                                  Type type,
+                                  const StorageOptions& storage = {}) {
+    variables_.push_back({name, dimensions, type, storage});
+    return *this;
+  }
+
+  /** Add sub-group to transaction.
+   *
+   * @param name Name of the group to add.
+   * @return Transaction for the contents of the new group. It is committed
+   *     together with this transaction.
+   */
+  DefineTransaction& add_group(std::string name) {
+    groups_.push_back(
+        std::unique_ptr<DefineTransaction>(new DefineTransaction(this, name)));
+    return *groups_.back();
+  }
+
+  /** Add group attribute to transaction.
+   *
+   * @param attribute The attribute to add.
+   * @return Reference to this transaction.
+   */
+  DefineTransaction& add_attribute(const Attribute& attribute) {
+    attributes_.push_back({"", attribute});
+    return *this;
+  }
+
+  /** Add numeric group attribute to transaction.
+   *
+   * @param name Name of the attribute.
+   * @param values The attribute values.
+   * @return Reference to this transaction.
+   */
+  template <typename T>
+  DefineTransaction& add_attribute(std::string name,
+                                   const std::vector<T>& values) {
+    return add_attribute(Attribute(name, values));
+  }
+
+  /// Add single-valued group attribute to transaction.
+  template <typename T>
+  DefineTransaction& add_attribute(std::string name, T value) {
+    return add_attribute(Attribute(name, std::vector<T>{value}));
+  }
+
+  /// Add text group attribute to transaction.
+  DefineTransaction& add_attribute(std::string name, std::string text) {
+    return add_attribute(Attribute(name, text));
+  }
+
+  /// Add text group attribute to transaction.
+  DefineTransaction& add_attribute(std::string name, const char* text) {
+    return add_attribute(Attribute(name, std::string(text)));
+  }
+
+  /// Add string group attribute to transaction.
+  DefineTransaction& add_attribute(std::string name,
+                                   const std::vector<std::string>& strings) {
+    return add_attribute(Attribute(name, strings));
+  }
+
+  /** Add variable attribute to transaction.
+   *
+   * @param variable Name of the variable, which may be defined in the
+   *     same transaction.
+   * @param attribute The attribute to add.
+   * @return Reference to this transaction.
+   */
+  DefineTransaction& add_variable_attribute(std::string variable,
+                                            const Attribute& attribute) {
+    attributes_.push_back({variable, attribute});
+    return *this;
+  }
+
+  /** Add numeric variable attribute to transaction.
+   *
+   * @param variable Name of the variable, which may be defined in the
+   *     same transaction.
+   * @param name Name of the attribute.
+   * @param values The attribute values.
+   * @return Reference to this transaction.
+   */
+  template <typename T>
+  DefineTransaction& add_variable_attribute(std::string variable,
+                                            std::string name,
+                                            const std::vector<T>& values) {
+    return add_variable_attribute(variable, Attribute(name, values));
+  }
+
+  /// Add single-valued variable attribute to transaction.
+  template <typename T>
+  DefineTransaction& add_variable_attribute(std::string variable,
+                                            std::string name,
+                                            T value) {
+    return add_variable_attribute(variable, Attribute(name, std::vector<T>{value}));
+  }
+
+  /// Add text variable attribute to transaction.
+  DefineTransaction& add_variable_attribute(std::string variable,
+                                            std::string name,
+                                            std::string text) {
+    return add_variable_attribute(variable, Attribute(name, text));
+  }
+
+  /// Add text variable attribute to transaction.
+  DefineTransaction& add_variable_attribute(std::string variable,
+                                            std::string name,
+                                            const char* text) {
+    return add_variable_attribute(variable, Attribute(name, std::string(text)));
+  }
+
+  /// Add string variable attribute to transaction.
+  DefineTransaction& add_variable_attribute(std::string variable,
+                                            std::string name,
+                                            const std::vector<std::string>& strings) {
+    return add_variable_attribute(variable, Attribute(name, strings));
+  }
+
+  /** Commit transaction.
+   *
+   * Creates all pending definitions in a single define-mode session and
+   * leaves define mode afterwards. The dimensions, variables and groups
+   * become available through the group for which the transaction was
+   * created.
+   *
+   * All definitions are checked for duplicate names and undefined
+   * dimensions or variables before the first definition is issued, so
+   * that these errors leave the file unchanged and the transaction can be
+   * corrected and committed again. Errors reported by the NetCDF-c library
+   * while the definitions are issued cannot be rolled back: the file then
+   * contains part of the definitions and should be considered unusable.
+   * Any later attempt to commit the same transaction throws.
+   */
+  void commit();
+
+ private:
+  Group* group_ = nullptr;
+  DefineTransaction* parent_ = nullptr;
+  std::string name_ = "";
+  int group_id_ = 0;
+  bool committed_ = false;
+  std::vector<DimensionDefinition> dimensions_ = {};
+  std::vector<VariableDefinition> variables_ = {};
+  std::vector<AttributeDefinition> attributes_ = {};
+  std::vector<std::unique_ptr<DefineTransaction>> groups_ = {};
+  std::map<std::string, int> dimension_ids_ = {};
+  std::map<std::string, int> variable_ids_ = {};
+};
+
+inline DefineTransaction Group::define() { return DefineTransaction(*this); }
+
+inline int DefineTransaction::find_dimension_id(const std::string& name) const {
+  auto found = dimension_ids_.find(name);
+  if (found != dimension_ids_.end()) {
+    return found->second;
+  }
+  if (parent_) {
+    return parent_->find_dimension_id(name);
+  }
+  group_->parse_dimensions();
+  auto dim = group_->dimensions_.find(name);
+  if (dim != group_->dimensions_.end()) {
+    return dim->second.id;
+  }
+  std::stringstream msg;
+  msg << "Dimension " << name << " is not defined.";
+  throw std::runtime_error(msg.str());
+}
+
+inline bool DefineTransaction::has_dimension(const std::string& name) const {
+  for (auto& d : dimensions_) {
+    if (d.name == name) {
+      return true;
+    }
+  }
+  if (parent_) {
+    return parent_->has_dimension(name);
+  }
+  group_->parse_dimensions();
+  return group_->dimensions_.find(name) != group_->dimensions_.end();
+}
+
+inline void DefineTransaction::validate() const {
+  auto fail = [](const std::string& what, const std::string& name) {
+    std::stringstream msg;
+    msg << what << " " << name << ".";
+    throw std::runtime_error(msg.str());
+  };
+  // Only the root transaction defines objects in an existing group. The
+  // group's variables and sub-groups are looked up directly so that
+  // cached objects are left untouched.
+  auto existing_variable = [this](const std::string& name) {
+    if (parent_) {
+      return false;
+    }
+    int var_id = 0;
+    int error = file().instrument(CallCategory::Inquire, [&] {
+      return nc_inq_varid(group_->id_, name.c_str(), &var_id);
+    });
+    return error == NC_NOERR;
+  };
+  auto existing_group = [this](const std::string& name) {
+    if (parent_) {
+      return false;
+    }
+    int group_id = 0;
+    int error = file().instrument(CallCategory::Inquire, [&] {
+      return nc_inq_grp_ncid(group_->id_, name.c_str(), &group_id);
+    });
+    return error == NC_NOERR;
+  };
+  if (!parent_) {
+    group_->parse_dimensions();
+  }
+  std::map<std::string, bool> names = {};
+  for (auto& d : dimensions_) {
+    if (names.count(d.name) ||
+        (!parent_ && group_->dimensions_.count(d.name))) {
+      fail("Duplicate dimension", d.name);
+    }
+    names[d.name] = true;
+  }
+  names.clear();
+  for (auto& v : variables_) {
+    if (names.count(v.name) || existing_variable(v.name)) {
+      fail("Duplicate variable", v.name);
+    }
+    names[v.name] = true;
+    for (auto& d : v.dimensions) {
+      if (!has_dimension(d)) {
+        fail("Dimension " + d + " is not defined for variable", v.name);
+      }
+    }
+  }
+  for (auto& a : attributes_) {
+    if (a.variable != "" && !names.count(a.variable) &&
+        !existing_variable(a.variable)) {
+      fail("Attribute " + a.attribute.get_name() + " refers to undefined variable",
+           a.variable);
+    }
+  }
+  names.clear();
+  for (auto& g : groups_) {
+    if (names.count(g->name_) || existing_group(g->name_)) {
+      fail("Duplicate group", g->name_);
+    }
+    names[g->name_] = true;
+    g->validate();
+  }
+}
+
+inline detail::FileID& DefineTransaction::file() const {
+  if (parent_) {
+    return parent_->file();
+  }
+  return *group_->file_ptr_;
+}
+
+inline void DefineTransaction::define(int group_id) {
+  group_id_ = group_id;
+  for (auto& d : dimensions_) {
+    int dim_id = 0;
+    int error = file().instrument(CallCategory::Define, [&] {
+      return nc_def_dim(group_id_, d.name.c_str(), d.size, &dim_id);
+    });
+    detail::handle_error("Error creating dimension " + d.name + ":", error);
+    dimension_ids_[d.name] = dim_id;
+  }
+  for (auto& v : variables_) {
+    std::vector<int> dim_ids;
+    dim_ids.reserve(v.dimensions.size());
+    for (auto& d : v.dimensions) {
+      dim_ids.push_back(find_dimension_id(d));
+    }
+    int var_id = 0;
+    int error = file().instrument(CallCategory::Define, [&] {
+      return nc_def_var(group_id_,
+                        v.name.c_str(),
+                        static_cast<int>(v.type),
+                        static_cast<int>(dim_ids.size()),
+                        dim_ids.data(),
+                        &var_id);
+    });
+    detail::handle_error("Error defining variable " + v.name + ":", error);
+    detail::define_storage(file(), group_id_, var_id, v.storage);
+    variable_ids_[v.name] = var_id;
+  }
+  for (auto& a : attributes_) {
+    int var_id = NC_GLOBAL;
+    if (a.variable != "") {
+      auto found = variable_ids_.find(a.variable);
+      if (found != variable_ids_.end()) {
+        var_id = found->second;
+      } else {
+        int error = file().instrument(CallCategory::Inquire, [&] {
+          return nc_inq_varid(group_id_, a.variable.c_str(), &var_id);
+        });
+        detail::handle_error("Error finding variable " + a.variable + ":", error);
+      }
+    }
+    a.attribute.write(file(), group_id_, var_id);
+  }
+  for (auto& g : groups_) {
+    int child_id = 0;
+    int error = file().instrument(CallCategory::Define, [&] {
+      return nc_def_grp(group_id_, g->name_.c_str(), &child_id);
+    });
+    detail::handle_error("Error creating group " + g->name_ + ":", error);
+    g->define(child_id);
+  }
+}
+
+inline void DefineTransaction::commit() {
+  if (parent_) {
+    throw std::runtime_error(
+        "Transactions of sub-groups are committed with their parent.");
+  }
+  if (committed_) {
+    throw std::runtime_error("Transaction has already been committed.");
+  }
+  validate();
+  committed_ = true;
+
+  auto& file = *group_->file_ptr_;
+  detail::assert_define_mode(file);
+  define(group_->id_);
+  detail::assert_write_mode(file);
+
+  for (auto& d : dimensions_) {
+    Dimension dim{d.name, static_cast<int>(d.size)};
+    dim.id = dimension_ids_[d.name];
+    dim.unlimited = d.unlimited;
+    group_->dimensions_[d.name] = dim;
+  }
+  for (auto& v : variables_) {
+    group_->variables_[v.name] =
+        Variable(group_->file_ptr_, group_->id_, variable_ids_[v.name]);
+  }
+  for (auto& g : groups_) {
+    group_->groups_[g->name_] =
+        Group(group_->file_ptr_, g->group_id_, g->name_);
+  }
+
+  // Make attributes of existing objects visible to their cached
+  // attributes.
+  for (auto& a : attributes_) {
+    if (a.variable == "") {
+      group_->attributes_.reset();
+    } else if (variable_ids_.find(a.variable) == variable_ids_.end()) {
+      auto found = group_->variables_.find(a.variable);
+      if (found != group_->variables_.end()) {
+        found->second.attributes_.reset();
+      }
+    }
   }
+}
 
-  /// Check whether group has subgroup of given name.
-  bool has_group(std::string name) {
-    auto found = groups_.find(name);
-    return found != groups_.end();
+////////////////////////////////////////////////////////////////////////////////
+// Memory buffer
+////////////////////////////////////////////////////////////////////////////////
+/** Memory block holding a serialized NetCDF file.
+ *
+ * Owns the memory that the NetCDF-c library returns when an in-memory
+ * file is closed and releases it when destroyed.
+ */
+class MemoryBuffer {
+  struct Free {
+    void operator()(void* memory) const { std::free(memory); }
+  };
+
+ public:
+  MemoryBuffer() = default;
+
+  /** Take ownership of memory block.
+   *
+   * @param memory Memory block allocated with malloc.
+   * @param size The size of the memory block in bytes.
+   */
+  MemoryBuffer(void* memory, size_t size)
+      : data_(static_cast<unsigned char*>(memory)), size_(size) {}
+
+  /// Pointer to the first byte of the file.
+  const unsigned char* data() const { return data_.get(); }
+  unsigned char* data() { return data_.get(); }
+
+  /// The size of the file in bytes.
+  size_t size() const { return size_; }
+
+  const unsigned char* begin() const { return data_.get(); }
+  const unsigned char* end() const { return data_.get() + size_; }
+
+  /** Release ownership of the memory block.
+   *
+   * @return Pointer to the memory block, which must be freed using free.
+   */
+  unsigned char* release() {
+    size_ = 0;
+    return data_.release();
   }
 
- protected:
-  std::shared_ptr<detail::FileID> file_ptr_;
-  int id_;
-  std::string name_;
-  int n_dims_, n_vars_, n_groups_, n_attrs_, n_unl_dims_;
-  std::map<std::string, Dimension> dimensions_ = {};
-  std::map<std::string, Variable> variables_ = {};
-  std::map<std::string, Group> groups_ = {};
+ private:
+  std::unique_ptr<unsigned char, Free> data_ = nullptr;
+  size_t size_ = 0;
+};
+
+/// Whether a file opened from memory uses a copy of the memory.
+enum class BufferMode {
+  /// Copy the data. The memory may be released after opening.
+  Copy,
+  /// Use the memory directly. It must outlive the file and remain
+  /// unchanged while the file is open.
+  ZeroCopy
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -788,15 +5885,72 @@ class File : public Group {
      * @param path The file's path
      * @param mode Creation mode defining whether or not to over-
      *        write an existing file.
+     * @param fill_mode Whether variables of the file are prefilled with
+     *        their fill value. Can be overridden per variable through
+     *        StorageOptions.
      * @return File instance representing the newly created file.
      */
   static File create(std::string path,
-                     CreationMode mode = CreationMode::Clobber) {
+                     CreationMode mode = CreationMode::Clobber,
+                     FillMode fill_mode = FillMode::Default) {
+    detail::TraceSpan span("File::create", "file");
+    if (span) {
+      span.add_arg("path", path);
+    }
     auto file = std::make_shared<detail::FileID>();
-    int error = nc_create(path.c_str(), static_cast<int>(mode), &file->id);
+    int error = file->instrument(CallCategory::File, [&] {
+      return nc_create(path.c_str(), static_cast<int>(mode), &file->id);
+    });
     detail::handle_error("Error creating file: " + path, error);
     file->open = true;
-    return File(file);
+    file->define_mode = true;
+    File result(file);
+    if (fill_mode != FillMode::Default) {
+      result.set_fill_mode(fill_mode);
+    }
+    return result;
+  }
+
+  /** Create new NetCDF4 file in memory.
+     *
+     * The file is held entirely in memory. Unless persist is set, it
+     * never touches the file system and its contents can be retrieved
+     * with close_to_memory.
+     *
+     * @param path Name of the file. If persist is set, the path the file
+     *        is written to when it is closed.
+     * @param persist Whether to write the file to path when it is closed.
+     * @param initial_size Initial size of the memory block in bytes. If
+     *        zero, the library default is used.
+     * @param fill_mode Whether variables of the file are prefilled with
+     *        their fill value.
+     * @return File instance representing the newly created file.
+     */
+  static File create_in_memory(std::string path = "in_memory.nc",
+                               bool persist = false,
+                               size_t initial_size = 0,
+                               FillMode fill_mode = FillMode::Default) {
+    detail::TraceSpan span("File::create_in_memory", "file");
+    if (span) {
+      span.add_arg("path", path);
+    }
+    auto file = std::make_shared<detail::FileID>();
+    int error = file->instrument(CallCategory::File, [&] {
+      if (persist) {
+        int mode = NC_NETCDF4 | NC_CLOBBER | NC_DISKLESS | NC_PERSIST;
+        return nc_create(path.c_str(), mode, &file->id);
+      }
+      return nc_create_mem(path.c_str(), NC_NETCDF4, initial_size, &file->id);
+    });
+    detail::handle_error("Error creating in-memory file: " + path, error);
+    file->open = true;
+    file->define_mode = true;
+    file->in_memory = !persist;
+    File result(file);
+    if (fill_mode != FillMode::Default) {
+      result.set_fill_mode(fill_mode);
+    }
+    return result;
   }
 
   /** Open NetCDF4 file.
@@ -804,23 +5958,728 @@ class File : public Group {
      * @param path The path to the file to open.
      * @param mode Opening mode defining whether write access
      *        is required.
+     * @param parse_mode Whether to parse the file's group tree
+     *        immediately or resolve its contents on first access.
      * @return File instance representing the opened file.
      */
-  static File open(std::string path, OpenMode mode = OpenMode::Write) {
+  static File open(std::string path,
+                   OpenMode mode = OpenMode::Write,
+                   ParseMode parse_mode = ParseMode::Lazy) {
+    detail::TraceSpan span("File::open", "file");
+    if (span) {
+      span.add_arg("path", path);
+    }
     auto file = std::make_shared<detail::FileID>();
-    int error = nc_open(path.c_str(), static_cast<int>(mode), &file->id);
+    int error = file->instrument(CallCategory::File, [&] {
+      return nc_open(path.c_str(), static_cast<int>(mode), &file->id);
+    });
     detail::handle_error("Error opening file: " + path, error);
     file->open = true;
+    file->eager_parsing = parse_mode == ParseMode::Eager;
+    file->read_only = mode == OpenMode::ReadOnly;
     return File(file);
   }
 
+  /** Open NetCDF4 file from memory.
+     *
+     * Opens a file whose complete contents are held in memory. Files
+     * opened from memory are read-only.
+     *
+     * @param data The bytes of the file.
+     * @param buffer_mode Whether to copy the data or use it directly.
+     * @param parse_mode Whether to parse the file's group tree
+     *        immediately or resolve its contents on first access.
+     * @param name Name used to identify the file in error messages.
+     * @return File instance representing the opened file.
+     */
+  static File open_memory(std::span<const std::byte> data,
+                          BufferMode buffer_mode = BufferMode::Copy,
+                          ParseMode parse_mode = ParseMode::Lazy,
+                          std::string name = "in_memory.nc") {
+    std::shared_ptr<const void> memory = nullptr;
+    if (buffer_mode == BufferMode::Copy) {
+      std::shared_ptr<std::byte[]> copy(new std::byte[data.size()]);
+      std::memcpy(copy.get(), data.data(), data.size());
+      data = {copy.get(), data.size()};
+      memory = copy;
+    }
+    return open_memory(data, memory, parse_mode, name);
+  }
+
+  /** Open NetCDF4 file from memory buffer.
+     *
+     * @param buffer Buffer holding the file, for example obtained from
+     *        close_to_memory. The file takes ownership of the buffer.
+     * @param parse_mode Whether to parse the file's group tree
+     *        immediately or resolve its contents on first access.
+     * @return File instance representing the opened file.
+     */
+  static File open_memory(MemoryBuffer buffer,
+                          ParseMode parse_mode = ParseMode::Lazy) {
+    auto owned = std::make_shared<MemoryBuffer>(std::move(buffer));
+    std::span<const std::byte> data{
+        reinterpret_cast<const std::byte*>(owned->data()), owned->size()};
+    return open_memory(data, owned, parse_mode, "in_memory.nc");
+  }
+
+#ifdef NETCDFHPP_HAS_MMAP
+  /** Open memory-mapped NetCDF4 file.
+     *
+     * Opens a file directly from its memory mapping without copying it.
+     * The mapping is kept alive by the file, so a single mapping can be
+     * shared by any number of files.
+     *
+     * @param mapping The memory-mapped file.
+     * @param parse_mode Whether to parse the file's group tree
+     *        immediately or resolve its contents on first access.
+     * @return File instance representing the opened file.
+     */
+  static File open_memory(std::shared_ptr<const MappedFile> mapping,
+                          ParseMode parse_mode = ParseMode::Lazy) {
+    return open_memory(mapping->bytes(), mapping, parse_mode, "mapped.nc");
+  }
+
+  /** Open NetCDF4 file through a memory mapping.
+     *
+     * @param path The path to the file to open.
+     * @param parse_mode Whether to parse the file's group tree
+     *        immediately or resolve its contents on first access.
+     * @return File instance representing the opened file.
+     */
+  static File open_mapped(std::string path,
+                          ParseMode parse_mode = ParseMode::Lazy) {
+    auto mapping = MappedFile::map(path);
+    return open_memory(mapping->bytes(), mapping, parse_mode, path);
+  }
+#endif
+
   File(std::shared_ptr<detail::FileID> file_ptr)
       : Group(file_ptr, *file_ptr, "") {}
 
+  /** Set default chunk cache.
+   *
+   * Sets the chunk cache settings that the NetCDF-c library applies to
+   * the variables of all files that are subsequently created or opened.
+   *
+   * @param cache The default chunk cache settings.
+   */
+  static void set_default_chunk_cache(const ChunkCache& cache) {
+    int error = nc_set_chunk_cache(cache.size, cache.n_elements, cache.preemption);
+    detail::handle_error("Error setting default chunk cache:", error);
+  }
+
+  /// The default chunk cache settings of the NetCDF-c library.
+  static ChunkCache get_default_chunk_cache() {
+    ChunkCache cache{};
+    int error = nc_get_chunk_cache(&cache.size, &cache.n_elements, &cache.preemption);
+    detail::handle_error("Error inquiring default chunk cache:", error);
+    return cache;
+  }
+
+  /** Set default data alignment.
+   *
+   * Requests that the data of variables larger than the given threshold
+   * in subsequently created NetCDF4 files starts at a multiple of the
+   * given alignment. Aligned contiguous variables can be mapped into
+   * memory without copying by Variable::map.
+   *
+   * @param threshold Minimum size in bytes of the data to align.
+   * @param alignment The alignment in bytes. 0 or 1 disable alignment.
+   */
+  static void set_default_alignment(size_t threshold, size_t alignment) {
+    // HDF5 rejects an alignment of 0, which NetCDF-c passes on as is.
+    alignment = std::max<size_t>(alignment, 1);
+    int error = nc_set_alignment(static_cast<int>(threshold),
+                                 static_cast<int>(alignment));
+    detail::handle_error("Error setting default alignment:", error);
+  }
+
+  /// The default data alignment as a pair of threshold and alignment.
+  static std::pair<size_t, size_t> get_default_alignment() {
+    int threshold = 0;
+    int alignment = 0;
+    int error = nc_get_alignment(&threshold, &alignment);
+    detail::handle_error("Error inquiring default alignment:", error);
+    return {static_cast<size_t>(threshold), static_cast<size_t>(alignment)};
+  }
+
+  /** Set fill mode of the file.
+   *
+   * The fill mode applies to variables that are defined after it is set.
+   *
+   * @param fill_mode The new fill mode.
+   * @return The previous fill mode.
+   */
+  FillMode set_fill_mode(FillMode fill_mode) {
+    file_ptr_->assert_writable();
+    if (fill_mode == FillMode::Default) {
+      fill_mode = FillMode::Fill;
+    }
+    int old_mode = 0;
+    int error = file_ptr_->instrument(CallCategory::Define, [&] {
+      return nc_set_fill(file_ptr_->id, static_cast<int>(fill_mode), &old_mode);
+    });
+    detail::handle_error("Error setting fill mode:", error);
+    return FillMode(old_mode);
+  }
+
   /// Close the file.
   void close() { file_ptr_->close(); }
 
+  /** Open file asynchronously.
+   *
+   * Awaitable version of open, which opens the file on the I/O executor
+   * thread.
+   *
+   * @param path The path of the file.
+   * @param mode The mode in which to open the file.
+   * @param parse_mode Whether to parse the file's structure when opening.
+   * @return Awaitable operation resulting in the opened file.
+   */
+  static IOAwaitable<File> open_async(std::string path,
+                                      OpenMode mode = OpenMode::Write,
+                                      ParseMode parse_mode = ParseMode::Lazy) {
+    return IOAwaitable<File>([path, mode, parse_mode] {
+      return File::open(path, mode, parse_mode);
+    });
+  }
+
+  /** Close file asynchronously.
+   *
+   * @return Awaitable operation that closes the file on the I/O
+   *     executor thread.
+   */
+  IOAwaitable<void> close_async() {
+    return IOAwaitable<void>([file_ptr = file_ptr_] { file_ptr->close(); });
+  }
+
+  /** Close in-memory file and retrieve its contents.
+   *
+   * @return Buffer holding the serialized file.
+   * @throw std::runtime_error if the file wasn't created with
+   *     create_in_memory or is already closed.
+   */
+  MemoryBuffer close_to_memory() {
+    NC_memio memio{};
+    file_ptr_->close_to_memory(memio);
+    return MemoryBuffer(memio.memory, memio.size);
+  }
+
+  /** I/O statistics of the file.
+   *
+   * @return Snapshot of the statistics of all library calls issued on
+   *     the file since it was opened or the statistics were last reset.
+   *     Empty unless NETCDFHPP_INSTRUMENTATION is defined.
+   */
+  IOStats get_io_stats() const {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    return file_ptr_->stats.get_file_stats();
+#else
+    return {};
+#endif
+  }
+
+  /// Reset the I/O statistics of the file and all its variables.
+  void reset_io_stats() {
+#ifdef NETCDFHPP_INSTRUMENTATION
+    file_ptr_->stats.reset();
+#endif
+  }
+
+ private:
+  // Opens file from memory that is kept alive by the given pointer.
+  static File open_memory(std::span<const std::byte> data,
+                          std::shared_ptr<const void> memory,
+                          ParseMode parse_mode,
+                          const std::string& name) {
+    detail::TraceSpan span("File::open_memory", "file");
+    if (span) {
+      span.add_arg("path", name);
+      span.add_arg("bytes", data.size());
+    }
+    auto file = std::make_shared<detail::FileID>();
+    NC_memio memio{};
+    memio.size = data.size();
+    memio.memory = const_cast<std::byte*>(data.data());
+    memio.flags = NC_MEMIO_LOCKED;
+    int error = file->instrument(CallCategory::File, [&] {
+      return nc_open_memio(name.c_str(), NC_NOWRITE | NC_INMEMORY, &memio, &file->id);
+    });
+    detail::handle_error("Error opening file from memory: " + name, error);
+    file->open = true;
+    file->eager_parsing = parse_mode == ParseMode::Eager;
+    file->read_only = true;
+    file->memory = memory;
+    return File(file);
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Asynchronous I/O
+////////////////////////////////////////////////////////////////////////////////
+
+/** Asynchronous file.
+ *
+ * Thread-safe handle of a NetCDF file whose library calls all run on
+ * the I/O executor thread. Requests can be issued from any thread and
+ * return futures, so that computations can continue while the I/O is
+ * performed. Requests are executed in the order in which they are
+ * issued.
+ *
+ * The file must not be accessed concurrently through other handles
+ * that don't use the I/O executor.
+ */
+class AsyncFile {
+  // State of the file, which is only accessed on the executor thread.
+  struct State {
+    File file;
+    std::map<std::string, Variable> variables = {};
+
+    Variable& get_variable(const std::string& name) {
+      auto found = variables.find(name);
+      if (found == variables.end()) {
+        found = variables.emplace(name, file.get_variable(name)).first;
+      }
+      return found->second;
+    }
+  };
+
+  AsyncFile(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+ public:
+  AsyncFile() = default;
+  AsyncFile(const AsyncFile&) = delete;
+  AsyncFile& operator=(const AsyncFile&) = delete;
+  AsyncFile(AsyncFile&&) = default;
+  AsyncFile& operator=(AsyncFile&& other) {
+    if (this != &other) {
+      close_and_wait();
+      state_ = std::move(other.state_);
+    }
+    return *this;
+  }
+
+  /// Closes the file after all pending requests have finished.
+  ~AsyncFile() { close_and_wait(); }
+
+  /** Create new file.
+   *
+   * @param path The path of the file.
+   * @param mode The creation mode.
+   * @return Asynchronous handle of the created file.
+   */
+  static AsyncFile create(std::string path,
+                          CreationMode mode = CreationMode::Clobber) {
+    auto& executor = detail::IOExecutor::get();
+    return AsyncFile(executor.run_sync([&] {
+      return std::make_shared<State>(State{File::create(path, mode)});
+    }));
+  }
+
+  /** Open existing file.
+   *
+   * @param path The path of the file.
+   * @param mode The mode in which to open the file.
+   * @param parse_mode Whether to parse the file's structure when opening.
+   * @return Asynchronous handle of the opened file.
+   */
+  static AsyncFile open(std::string path,
+                        OpenMode mode = OpenMode::Write,
+                        ParseMode parse_mode = ParseMode::Lazy) {
+    auto& executor = detail::IOExecutor::get();
+    return AsyncFile(executor.run_sync([&] {
+      return std::make_shared<State>(State{File::open(path, mode, parse_mode)});
+    }));
+  }
+
+  /** Run call on the file.
+   *
+   * Runs an arbitrary call on the file on the executor thread.
+   *
+   * @param call Callable that takes a reference to the File object.
+   * @return Future holding the result of the call.
+   */
+  template <typename F>
+  auto submit(F&& call) -> std::future<std::invoke_result_t<F, File&>> {
+    auto state = get_state();
+    return detail::IOExecutor::get().submit(
+        [state, call = std::forward<F>(call)]() mutable { return call(state->file); });
+  }
+
+  /** Read hyperslab into buffer.
+   *
+   * @param variable The name of the variable.
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @param data Destination of the read. Must stay valid until the
+   *     returned future is ready.
+   * @return Future that becomes ready when the data has been read.
+   */
+  template <typename T, size_t N_DIMS>
+  std::future<void> read(std::string variable,
+                         std::array<size_t, N_DIMS> starts,
+                         std::array<size_t, N_DIMS> counts,
+                         T* data) {
+    auto state = get_state();
+    return detail::IOExecutor::get().submit(
+        [state, variable = std::move(variable), starts, counts, data] {
+          state->get_variable(variable).read(starts, counts, data);
+        });
+  }
+
+  /** Read hyperslab into new buffer.
+   *
+   * @param variable The name of the variable.
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @return Future holding the data of the hyperslab in row-major order.
+   */
+  template <typename T, size_t N_DIMS>
+  std::future<std::vector<T>> read(std::string variable,
+                                   std::array<size_t, N_DIMS> starts,
+                                   std::array<size_t, N_DIMS> counts) {
+    auto state = get_state();
+    return detail::IOExecutor::get().submit(
+        [state, variable = std::move(variable), starts, counts] {
+          std::vector<T> data(detail::n_elements(counts));
+          state->get_variable(variable).read(starts, counts, data.data());
+          return data;
+        });
+  }
+
+  /** Write hyperslab from buffer.
+   *
+   * @param variable The name of the variable.
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @param data The data to write. Must stay valid until the returned
+   *     future is ready.
+   * @return Future that becomes ready when the data has been written.
+   */
+  template <typename T, size_t N_DIMS>
+  std::future<void> write(std::string variable,
+                          std::array<size_t, N_DIMS> starts,
+                          std::array<size_t, N_DIMS> counts,
+                          const T* data) {
+    auto state = get_state();
+    return detail::IOExecutor::get().submit(
+        [state, variable = std::move(variable), starts, counts, data] {
+          state->get_variable(variable).write(starts, counts, data);
+        });
+  }
+
+  /** Write hyperslab from owned buffer.
+   *
+   * @param variable The name of the variable.
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @param data The data to write. Ownership is transferred to the
+   *     request.
+   * @return Future that becomes ready when the data has been written.
+   */
+  template <typename T, size_t N_DIMS>
+  std::future<void> write(std::string variable,
+                          std::array<size_t, N_DIMS> starts,
+                          std::array<size_t, N_DIMS> counts,
+                          std::vector<T> data) {
+    if (data.size() != detail::n_elements(counts)) {
+      throw std::runtime_error("Size of data doesn't match extents of hyperslab.");
+    }
+    auto state = get_state();
+    auto buffer = std::make_shared<std::vector<T>>(std::move(data));
+    return detail::IOExecutor::get().submit(
+        [state, variable = std::move(variable), starts, counts, buffer] {
+          const T* data = buffer->data();
+          state->get_variable(variable).write(starts, counts, data);
+        });
+  }
+
+  /// Flush data written to the file to disk.
+  std::future<void> sync() {
+    return submit([](File& file) { file.sync(); });
+  }
+
+  /** Close file.
+   *
+   * Closes the file after all previously issued requests have finished.
+   * Requests issued after closing fail.
+   *
+   * @return Future that becomes ready when the file is closed.
+   */
+  std::future<void> close() {
+    return submit([](File& file) { file.close(); });
+  }
+
+ private:
+  std::shared_ptr<State> get_state() const {
+    if (!state_) {
+      throw std::runtime_error("Asynchronous file handle is empty.");
+    }
+    return state_;
+  }
+
+  // Closes the file and waits for it. Errors are ignored since this is
+  // called from the destructor.
+  void close_and_wait() {
+    if (!state_) {
+      return;
+    }
+    auto state = std::move(state_);
+    try {
+      detail::IOExecutor::get().run_sync([&state] { state->file.close(); });
+    } catch (const std::exception&) {
+    }
+    state_ = nullptr;
+  }
+
+  std::shared_ptr<State> state_ = nullptr;
+};
+
+/** Multi-producer write queue.
+ *
+ * Collects hyperslab writes to a single variable from any number of
+ * producer threads and performs them on a dedicated writer thread.
+ * Producers hand over ownership of their buffers, so that data isn't
+ * copied, and are only blocked when the queue is full or when the
+ * buffered data exceeds the memory budget of the queue.
+ *
+ * Submission is lock-free: requests are placed in a bounded ring
+ * buffer whose slots carry sequence numbers, so that producers only
+ * contend on a single atomic counter.
+ *
+ * While the queue is alive, the file must not be accessed from other
+ * threads except between a call to flush and the next push.
+ *
+ * Errors that occur while writing are reported by the next call to
+ * flush or close. The destructor writes remaining requests on a
+ * best-effort basis and discards their errors, so close should be
+ * called explicitly where they matter.
+ *
+ * @tparam T The C++ type of the data.
+ * @tparam N_DIMS The number of dimensions of the variable.
+ */
+template <typename T, size_t N_DIMS>
+class WriteQueue {
+  // A queued write request.
+  struct Request {
+    std::array<size_t, N_DIMS> starts = {};
+    std::array<size_t, N_DIMS> counts = {};
+    std::vector<T> data = {};
+    bool stop = false;
+  };
+
+  // Slot of the ring buffer. The sequence number of a slot that can
+  // be filled equals the position of the request that goes into it and
+  // is incremented once the request has been stored.
+  struct Slot {
+    std::atomic<size_t> sequence;
+    Request request;
+  };
+
+ public:
+  /** Create queue.
+   *
+   * @param variable The variable to write to.
+   * @param memory_budget Maximum size in bytes of the data of queued
+   *     requests. A single request that exceeds the budget is accepted
+   *     when the queue is empty.
+   * @param capacity Maximum number of queued requests. Rounded up to a
+   *     power of two.
+   */
+  WriteQueue(Variable variable,
+             size_t memory_budget = 256 << 20,
+             size_t capacity = 1024)
+      : variable_(variable),
+        memory_budget_(memory_budget),
+        capacity_(std::bit_ceil(std::max<size_t>(capacity, 2))),
+        slots_(new Slot[capacity_]) {
+    variable_.check_type<T>();
+    variable_.check_rank(N_DIMS);
+    variable_.file_ptr_->assert_writable();
+    for (size_t i = 0; i < capacity_; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer_ = std::thread([this] { run(); });
+  }
+
+  WriteQueue(const WriteQueue&) = delete;
+  WriteQueue& operator=(const WriteQueue&) = delete;
+
+  /** Stop queue.
+   *
+   * Writes all queued requests and stops the writer thread unless the
+   * queue has been closed. Errors are discarded.
+   */
+  ~WriteQueue() { stop(); }
+
+  /** Queue hyperslab write.
+   *
+   * Blocks while the queue is full or the memory budget is exhausted.
+   *
+   * @param starts The start indices of the hyperslab.
+   * @param counts The extents of the hyperslab.
+   * @param data The data to write. Ownership is transferred to the queue.
+   */
+  void push(std::array<size_t, N_DIMS> starts,
+            std::array<size_t, N_DIMS> counts,
+            std::vector<T>&& data) {
+    if (data.size() != detail::n_elements(counts)) {
+      throw std::runtime_error("Size of data doesn't match extents of hyperslab.");
+    }
+    if (!writer_.joinable()) {
+      throw std::runtime_error("Cannot push to closed write queue.");
+    }
+    reserve(data.size() * sizeof(T));
+    enqueue(Request{starts, counts, std::move(data), false});
+  }
+
+  /** Wait for queued writes.
+   *
+   * Blocks until all requests that were pushed before the call have
+   * been written to the variable. Used as barrier at the end of each
+   * time step.
+   *
+   * @throw The first exception that occurred during writing since the
+   *     last flush.
+   */
+  void flush() {
+    size_t target = enqueue_position_.load(std::memory_order_acquire);
+    size_t completed = completed_.load(std::memory_order_acquire);
+    while (completed < target) {
+      completed_.wait(completed, std::memory_order_acquire);
+      completed = completed_.load(std::memory_order_acquire);
+    }
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    if (error_) {
+      auto error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  /** Close queue.
+   *
+   * Writes all queued requests and stops the writer thread. No requests
+   * may be pushed afterwards. Must not be called concurrently with push.
+   *
+   * @throw The first exception that occurred during writing since the
+   *     last flush.
+   */
+  void close() {
+    stop();
+    flush();
+  }
+
+  /// Size in bytes of the data of the queued requests.
+  size_t get_buffered_bytes() const {
+    return buffered_bytes_.load(std::memory_order_relaxed);
+  }
+
+  /// The maximum number of queued requests.
+  size_t get_capacity() const { return capacity_; }
+
  private:
+  // Enqueues a stop request and waits for the writer thread to finish
+  // the requests before it.
+  void stop() {
+    if (writer_.joinable()) {
+      enqueue(Request{{}, {}, {}, true});
+      writer_.join();
+    }
+  }
+
+  // Waits until the given number of bytes fits into the memory budget
+  // and reserves them.
+  void reserve(size_t bytes) {
+    size_t buffered = buffered_bytes_.load(std::memory_order_relaxed);
+    while (true) {
+      if (buffered > 0 && buffered + bytes > memory_budget_) {
+        buffered_bytes_.wait(buffered, std::memory_order_relaxed);
+        buffered = buffered_bytes_.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (buffered_bytes_.compare_exchange_weak(
+              buffered, buffered + bytes, std::memory_order_relaxed)) {
+        return;
+      }
+    }
+  }
+
+  // Claims the next position in the ring and stores the request.
+  void enqueue(Request&& request) {
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true) {
+      slot = &slots_[position & (capacity_ - 1)];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+      if (difference == 0) {
+        if (enqueue_position_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        // The queue is full. Wait until the writer frees the slot.
+        slot->sequence.wait(sequence, std::memory_order_acquire);
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      } else {
+        position = enqueue_position_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->request = std::move(request);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    slot->sequence.notify_all();
+  }
+
+  // Writer loop: takes requests from the ring in order and writes them.
+  void run() {
+    size_t position = 0;
+    while (true) {
+      Slot& slot = slots_[position & (capacity_ - 1)];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence != position + 1) {
+        slot.sequence.wait(sequence, std::memory_order_acquire);
+        continue;
+      }
+      Request request = std::move(slot.request);
+      slot.request = Request{};
+      slot.sequence.store(position + capacity_, std::memory_order_release);
+      slot.sequence.notify_all();
+      ++position;
+      if (request.stop) {
+        completed_.store(position, std::memory_order_release);
+        completed_.notify_all();
+        return;
+      }
+
+      size_t bytes = request.data.size() * sizeof(T);
+      try {
+        const T* data = request.data.data();
+        variable_.write(request.starts, request.counts, data);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) {
+          error_ = std::current_exception();
+        }
+      }
+      request.data = {};
+      buffered_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+      buffered_bytes_.notify_all();
+      completed_.store(position, std::memory_order_release);
+      completed_.notify_all();
+    }
+  }
+
+  Variable variable_;
+  size_t memory_budget_;
+  size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(64) std::atomic<size_t> enqueue_position_ = 0;
+  alignas(64) std::atomic<size_t> completed_ = 0;
+  alignas(64) std::atomic<size_t> buffered_bytes_ = 0;
+  std::mutex error_mutex_;
+  std::exception_ptr error_ = nullptr;
+  std::thread writer_;
 };
 
 }  // namespace netcdf4
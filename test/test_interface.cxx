@@ -2,6 +2,12 @@
 #include "catch2/catch.hpp"
 #include <netcdf.hpp>
 #include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <latch>
+#include <numeric>
+#include <thread>
 
 netcdf4::File create_test_file(std::string name) {
     auto file = netcdf4::File::create(name);
@@ -198,3 +204,1415 @@ TEST_CASE( "test_read_write_single_value", "[netcdf]" ) {
 
     REQUIRE(value == 99);
 }
+
+TEST_CASE( "test_define_data_mode_transitions", "[netcdf]" ) {
+
+    std::string name = "test_define_data_mode.nc";
+    auto file = create_test_file(name);
+
+    auto int_var = file.get_variable("int_single_value");
+    int_var.write(1);
+    REQUIRE(int_var.read<int>() == 1);
+
+    // Defining new variables after data access requires re-entering define mode.
+    file.add_dimension("dimension_3", 5);
+    auto new_var = file.add_variable("int_single_value_2", {}, netcdf4::Type::Int);
+    new_var.write(2);
+    REQUIRE(new_var.read<int>() == 2);
+    REQUIRE(int_var.read<int>() == 1);
+    file.close();
+
+    file = open_test_file(name);
+    REQUIRE(file.get_variable("int_single_value").read<int>() == 1);
+    REQUIRE(file.get_variable("int_single_value_2").read<int>() == 2);
+    file.add_variable("int_single_value_3", {}, netcdf4::Type::Int).write(3);
+    REQUIRE(file.get_variable("int_single_value_3").read<int>() == 3);
+}
+
+TEST_CASE( "test_define_transaction", "[netcdf]" ) {
+
+    std::string name = "test_define_transaction.nc";
+    auto file = netcdf4::File::create(name);
+    file.add_dimension("dimension_1", 10);
+
+    auto tx = file.define();
+    tx.add_dimension("dimension_2", 20);
+    tx.add_dimension("dimension_unlimited");
+    tx.add_variable("int_variable", {"dimension_1", "dimension_2"}, netcdf4::Type::Int);
+    tx.add_variable("float_variable",
+                    {"dimension_unlimited", "dimension_2"},
+                    netcdf4::Type::Float);
+    tx.add_attribute("title", "test file");
+    tx.add_variable_attribute("float_variable", "scale_factor", 0.5f);
+    auto& sub_tx = tx.add_group("sub_group");
+    sub_tx.add_dimension("dimension_3", 3);
+    sub_tx.add_variable("sub_variable", {"dimension_1", "dimension_3"}, netcdf4::Type::Double);
+
+    // Nothing is defined before commit.
+    REQUIRE(!file.has_variable("int_variable"));
+    tx.commit();
+
+    REQUIRE(file.has_variable("int_variable"));
+    REQUIRE(file.has_variable("float_variable"));
+    REQUIRE(file.get_dimension("dimension_2").size == 20);
+    REQUIRE(file.get_dimension("dimension_unlimited").is_unlimited());
+    REQUIRE(file.has_group("sub_group"));
+    auto sub_var = file.get_group("sub_group").get_variable("sub_variable");
+    REQUIRE(sub_var.shape() == std::vector<size_t>{10, 3});
+
+    std::vector<int> data(200, 3);
+    file.get_variable("int_variable").write(data.data());
+    file.close();
+
+    file = open_test_file(name);
+    REQUIRE(file.get_variable("int_variable").shape() == std::vector<size_t>{10, 20});
+    REQUIRE(file.get_group("sub_group").has_variable("sub_variable"));
+    std::vector<int> data_read(200);
+    file.get_variable("int_variable").read(data_read.data());
+    REQUIRE(data_read == data);
+
+    float scale_factor = 0.0f;
+    auto float_var = file.get_variable("float_variable");
+    nc_get_att_float(file.get_id(), float_var.get_id(), "scale_factor", &scale_factor);
+    REQUIRE(scale_factor == 0.5f);
+
+    // Uncommitted transactions are discarded.
+    {
+        auto discarded = file.define();
+        discarded.add_dimension("dimension_4", 4);
+    }
+    REQUIRE_THROWS(file.get_dimension("dimension_4"));
+
+    // Moved transactions keep their sub-group transactions attached.
+    auto moved_from = file.define();
+    moved_from.add_dimension("dimension_5", 5);
+    moved_from.add_group("moved_group")
+        .add_variable("moved_variable", {"dimension_5"}, netcdf4::Type::Int);
+    auto moved = std::move(moved_from);
+    moved.commit();
+    REQUIRE(file.get_group("moved_group").get_variable("moved_variable").shape() ==
+            std::vector<size_t>{5});
+
+    // Invalid definitions are rejected before anything is defined.
+    auto invalid = file.define();
+    invalid.add_variable("invalid_variable", {"dimension_6"}, netcdf4::Type::Int);
+    invalid.add_group("invalid_group");
+    REQUIRE_THROWS(invalid.commit());
+    REQUIRE(!file.has_group("invalid_group"));
+    invalid.add_dimension("dimension_6", 6);
+    invalid.commit();
+    REQUIRE(file.get_variable("invalid_variable").shape() == std::vector<size_t>{6});
+    REQUIRE_THROWS(invalid.commit());
+
+    auto duplicate = file.define();
+    duplicate.add_dimension("dimension_1", 1);
+    REQUIRE_THROWS(duplicate.commit());
+    auto undefined = file.define();
+    undefined.add_variable_attribute("missing_variable", "units", "m");
+    REQUIRE_THROWS(undefined.commit());
+}
+
+TEST_CASE( "test_lazy_and_eager_parsing", "[netcdf]" ) {
+
+    std::string name = "test_lazy_and_eager_parsing.nc";
+    auto file = create_test_file(name);
+    auto tx = file.define();
+    auto& group_tx = tx.add_group("group_1");
+    group_tx.add_dimension("dimension_3", 3);
+    group_tx.add_variable("variable", {"dimension_3"}, netcdf4::Type::Float);
+    group_tx.add_group("group_2").add_variable("variable", {}, netcdf4::Type::Int);
+    tx.commit();
+    file.close();
+
+    for (auto parse_mode : {netcdf4::ParseMode::Lazy, netcdf4::ParseMode::Eager}) {
+        file = netcdf4::File::open(name, netcdf4::OpenMode::Write, parse_mode);
+        REQUIRE(file.has_variable("int_variable"));
+        REQUIRE(!file.has_variable("missing_variable"));
+        REQUIRE_THROWS(file.get_variable("missing_variable"));
+        REQUIRE(!file.has_group("missing_group"));
+        REQUIRE_THROWS(file.get_group("missing_group"));
+
+        auto group_1 = file.get_group("group_1");
+        REQUIRE(group_1.get_dimension("dimension_3").size == 3);
+        REQUIRE(group_1.get_variable("variable").shape() == std::vector<size_t>{3});
+        REQUIRE(group_1.get_group_names() == std::vector<std::string>{"group_2"});
+        REQUIRE(group_1.get_group("group_2").has_variable("variable"));
+        REQUIRE(file.get_group_names() == std::vector<std::string>{"group_1"});
+        file.close();
+    }
+}
+
+TEST_CASE( "test_storage_options", "[netcdf]" ) {
+
+    std::string name = "test_storage_options.nc";
+    auto file = create_test_file(name);
+
+    netcdf4::StorageOptions chunked{};
+    chunked.chunk_sizes = {1, 10, 5};
+    chunked.deflate_level = 4;
+    chunked.shuffle = true;
+    chunked.fletcher32 = true;
+    std::vector<std::string> dimensions = {
+        "dimension_unlimited", "dimension_1", "dimension_2"};
+    auto chunked_var = file.add_variable("chunked", dimensions, netcdf4::Type::Float, chunked);
+
+    netcdf4::StorageOptions contiguous{};
+    contiguous.layout = netcdf4::Layout::Contiguous;
+    auto contiguous_var = file.add_variable(
+        "contiguous", {"dimension_1", "dimension_2"}, netcdf4::Type::Int, contiguous);
+
+    auto tx = file.define();
+    netcdf4::StorageOptions compact{};
+    compact.layout = netcdf4::Layout::Compact;
+    tx.add_variable("compact", {"dimension_1"}, netcdf4::Type::Int, compact);
+    tx.commit();
+
+    auto storage = chunked_var.get_storage();
+    REQUIRE(storage.layout == netcdf4::Layout::Chunked);
+    REQUIRE(storage.chunk_sizes == std::vector<size_t>{1, 10, 5});
+    REQUIRE(storage.deflate_level == 4);
+    REQUIRE(storage.shuffle);
+    REQUIRE(storage.fletcher32);
+
+    std::vector<float> data(10 * 20, 1.5f);
+    chunked_var.write(std::array<size_t, 3>{0, 0, 0},
+                      std::array<size_t, 3>{1, 10, 20},
+                      data.data());
+    file.close();
+
+    file = open_test_file(name);
+    storage = file.get_variable("contiguous").get_storage();
+    REQUIRE(storage.layout == netcdf4::Layout::Contiguous);
+    REQUIRE(storage.chunk_sizes.empty());
+    REQUIRE(storage.deflate_level == 0);
+    REQUIRE(!storage.shuffle);
+    REQUIRE(file.get_variable("compact").get_storage().layout == netcdf4::Layout::Compact);
+    REQUIRE(file.get_variable("chunked").get_storage().chunk_sizes == std::vector<size_t>{1, 10, 5});
+
+    std::vector<float> data_read(10 * 20);
+    file.get_variable("chunked").read(std::array<size_t, 3>{0, 0, 0},
+                                      std::array<size_t, 3>{1, 10, 20},
+                                      data_read.data());
+    REQUIRE(data_read == data);
+}
+
+TEST_CASE( "test_chunk_cache", "[netcdf]" ) {
+
+    auto default_cache = netcdf4::File::get_default_chunk_cache();
+    netcdf4::ChunkCache cache{};
+    cache.size = 1 << 24;
+    cache.n_elements = 1009;
+    cache.preemption = 0.5;
+    netcdf4::File::set_default_chunk_cache(cache);
+    auto cache_read = netcdf4::File::get_default_chunk_cache();
+    REQUIRE(cache_read.size == cache.size);
+    REQUIRE(cache_read.n_elements == cache.n_elements);
+    REQUIRE(cache_read.preemption == cache.preemption);
+    netcdf4::File::set_default_chunk_cache(default_cache);
+
+    std::string name = "test_chunk_cache.nc";
+    auto file = netcdf4::File::create(name);
+    file.add_dimension("x", 100);
+    file.add_dimension("y", 100);
+    netcdf4::StorageOptions storage{};
+    storage.chunk_sizes = {10, 20};
+    storage.deflate_level = 1;
+    auto var = file.add_variable("chunked", {"x", "y"}, netcdf4::Type::Float, storage);
+
+    cache.size = 1 << 10;
+    cache.n_elements = 7;
+    var.set_chunk_cache(cache);
+    cache_read = var.get_chunk_cache();
+    REQUIRE(cache_read.size == cache.size);
+    REQUIRE(cache_read.n_elements == cache.n_elements);
+
+    // Hyperslab touching 2 x 3 chunks of 10 x 20 floats.
+    cache_read = var.fit_chunk_cache(std::array<size_t, 2>{5, 0},
+                                     std::array<size_t, 2>{10, 50});
+    REQUIRE(cache_read.size == 6 * 10 * 20 * sizeof(float));
+    REQUIRE(cache_read.n_elements == 61);
+    REQUIRE(var.get_chunk_cache().size == cache_read.size);
+
+    // Cache is not shrunk for smaller hyperslabs.
+    cache_read = var.fit_chunk_cache(std::array<size_t, 2>{0, 0},
+                                     std::array<size_t, 2>{1, 1});
+    REQUIRE(cache_read.size == 6 * 10 * 20 * sizeof(float));
+
+    var.set_chunk_cache_policy(netcdf4::ChunkCachePolicy::Auto);
+    std::vector<float> data(100 * 100);
+    var.read(std::array<size_t, 2>{0, 0}, std::array<size_t, 2>{100, 100}, data.data());
+    REQUIRE(var.get_chunk_cache().size == 100 * 100 * sizeof(float));
+}
+
+template <typename T>
+void test_type_round_trip(netcdf4::File& file, std::string name, netcdf4::Type type) {
+    auto var = file.add_variable(name, {"dimension_1"}, type);
+    REQUIRE(var.get_type() == type);
+    std::vector<T> data(10);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<T>(i + 1);
+    }
+    var.write(data.data());
+    std::vector<T> data_read(10);
+    var.read(data_read.data());
+    REQUIRE(data_read == data);
+    var.write(std::array<size_t, 1>{2}, std::array<size_t, 1>{1}, data.data());
+    REQUIRE(var.template read<T>() == static_cast<T>(1));
+}
+
+TEST_CASE( "test_atomic_types", "[netcdf]" ) {
+
+    std::string name = "test_atomic_types.nc";
+    auto file = create_test_file(name);
+
+    test_type_round_trip<signed char>(file, "byte", netcdf4::Type::Byte);
+    test_type_round_trip<char>(file, "char", netcdf4::Type::Char);
+    test_type_round_trip<unsigned char>(file, "ubyte", netcdf4::Type::UByte);
+    test_type_round_trip<short>(file, "short", netcdf4::Type::Short);
+    test_type_round_trip<unsigned short>(file, "ushort", netcdf4::Type::UShort);
+    test_type_round_trip<int>(file, "int", netcdf4::Type::Int);
+    test_type_round_trip<unsigned int>(file, "uint", netcdf4::Type::UInt);
+    test_type_round_trip<long long>(file, "int64", netcdf4::Type::Int64);
+    test_type_round_trip<unsigned long long>(file, "uint64", netcdf4::Type::UInt64);
+    test_type_round_trip<std::int64_t>(file, "int64_t", netcdf4::Type::Int64);
+    test_type_round_trip<std::uint64_t>(file, "uint64_t", netcdf4::Type::UInt64);
+    test_type_round_trip<float>(file, "float", netcdf4::Type::Float);
+    test_type_round_trip<double>(file, "double", netcdf4::Type::Double);
+
+    auto string_var = file.add_variable("string", {"dimension_1"}, netcdf4::Type::String);
+    std::vector<std::string> strings = {"a", "bb", "ccc", "", "e", "f", "g", "h", "i", "j"};
+    std::vector<char*> string_ptrs;
+    for (auto& string : strings) {
+        string_ptrs.push_back(const_cast<char*>(string.c_str()));
+    }
+    string_var.write(string_ptrs.data());
+    REQUIRE(string_var.read_strings() == strings);
+
+    REQUIRE_THROWS(file.get_variable("short").read<int>());
+
+    // Visitor dispatch on the variable's runtime type.
+    auto sum = [](auto& data) -> double {
+        using T = typename std::decay_t<decltype(data)>::value_type;
+        if constexpr (std::is_same_v<T, std::string>) {
+            return static_cast<double>(data.size());
+        } else {
+            double result = 0.0;
+            for (auto& x : data) {
+                result += static_cast<double>(x);
+            }
+            return result;
+        }
+    };
+    file.close();
+
+    file = open_test_file(name);
+    for (auto var_name : {"byte", "ubyte", "short", "ushort", "int", "uint",
+                          "int64", "uint64", "float", "double"}) {
+        REQUIRE(file.get_variable(var_name).visit(sum) == 53.0);
+    }
+    REQUIRE(file.get_variable("string").visit(sum) == 10.0);
+}
+
+TEST_CASE( "test_converting_read_write", "[netcdf]" ) {
+
+    std::string name = "test_converting_read_write.nc";
+    auto file = create_test_file(name);
+    auto short_var = file.add_variable("short", {"dimension_1", "dimension_2"}, netcdf4::Type::Short);
+    auto double_var = file.add_variable("double", {"dimension_1", "dimension_2"}, netcdf4::Type::Double);
+    auto int64_var = file.add_variable("int64", {"dimension_1"}, netcdf4::Type::Int64);
+
+    std::vector<double> values(200);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<double>(i) - 100.0;
+    }
+    short_var.write_as(values.data());
+    double_var.write_as(values.data());
+    int64_var.write_as(std::array<size_t, 1>{0}, std::array<size_t, 1>{10}, values.data());
+
+    for (auto conversion : {netcdf4::Conversion::Native, netcdf4::Conversion::Library}) {
+        // Widening conversion.
+        std::vector<float> floats(200);
+        short_var.read_as(floats.data(), conversion);
+        for (size_t i = 0; i < floats.size(); ++i) {
+            REQUIRE(floats[i] == static_cast<float>(values[i]));
+        }
+        // Narrowing conversion.
+        std::vector<int> ints(20);
+        double_var.read_as(std::array<size_t, 2>{1, 0},
+                           std::array<size_t, 2>{1, 20},
+                           ints.data(),
+                           conversion);
+        for (size_t i = 0; i < ints.size(); ++i) {
+            REQUIRE(ints[i] == static_cast<int>(values[20 + i]));
+        }
+        std::vector<double> doubles(10);
+        int64_var.read_as(doubles.data(), conversion);
+        for (size_t i = 0; i < doubles.size(); ++i) {
+            REQUIRE(doubles[i] == values[i]);
+        }
+    }
+    REQUIRE(short_var.read_as<double>() == -100.0);
+    REQUIRE_THROWS(file.add_variable("string", {}, netcdf4::Type::String).read_as<double>());
+}
+
+// NaN check that is robust to -ffast-math.
+template <typename T>
+bool is_nan_bits(T value) {
+    if constexpr (sizeof(T) == 4) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        return ((bits & 0x7f800000u) == 0x7f800000u) && (bits & 0x007fffffu);
+    } else {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        return ((bits & 0x7ff0000000000000ull) == 0x7ff0000000000000ull) &&
+               (bits & 0x000fffffffffffffull);
+    }
+}
+
+template <typename T>
+void check_cf_decoding(netcdf4::Variable& var, const std::vector<short>& packed) {
+    std::vector<T> decoded(200);
+    var.read_cf(decoded.data());
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        short p = packed[i];
+        if (p == -999 || p < -500 || p > 500) {
+            REQUIRE(is_nan_bits(decoded[i]));
+        } else {
+            REQUIRE(decoded[i] == Approx(static_cast<T>(p) * static_cast<T>(0.1) + static_cast<T>(5.0)));
+        }
+    }
+    std::vector<T> slab(20);
+    var.read_cf(std::array<size_t, 2>{3, 0}, std::array<size_t, 2>{1, 20}, slab.data());
+    for (size_t i = 0; i < slab.size(); ++i) {
+        if (is_nan_bits(decoded[60 + i])) {
+            REQUIRE(is_nan_bits(slab[i]));
+        } else {
+            REQUIRE(slab[i] == decoded[60 + i]);
+        }
+    }
+}
+
+TEST_CASE( "test_cf_decoding", "[netcdf]" ) {
+
+    std::string name = "test_cf_decoding.nc";
+    auto file = create_test_file(name);
+    auto tx = file.define();
+    tx.add_variable("packed", {"dimension_1", "dimension_2"}, netcdf4::Type::Short);
+    tx.add_variable_attribute("packed", "scale_factor", 0.1f);
+    tx.add_variable_attribute("packed", "add_offset", 5.0f);
+    tx.add_variable_attribute("packed", "_FillValue", static_cast<short>(-999));
+    tx.add_variable_attribute("packed", "valid_range", std::vector<short>{-500, 500});
+    tx.add_variable("unpacked_range", {"dimension_1", "dimension_2"}, netcdf4::Type::Short);
+    tx.add_variable_attribute("unpacked_range", "scale_factor", 0.1f);
+    tx.add_variable_attribute("unpacked_range", "add_offset", 5.0f);
+    tx.add_variable_attribute("unpacked_range", "valid_min", -45.0f);
+    tx.add_variable_attribute("unpacked_range", "valid_max", 55.0f);
+    tx.commit();
+
+    std::vector<short> packed(200);
+    for (size_t i = 0; i < packed.size(); ++i) {
+        packed[i] = static_cast<short>(i * 7) - 700;
+    }
+    packed[10] = -999;
+    auto var = file.get_variable("packed");
+    var.write(packed.data());
+    check_cf_decoding<float>(var, packed);
+    check_cf_decoding<double>(var, packed);
+
+    auto packing = var.get_cf_packing();
+    REQUIRE(packing.has_fill_value);
+    REQUIRE(packing.fill_value == -999.0);
+    REQUIRE(packing.valid_min == -500.0);
+    REQUIRE(packing.valid_max == 500.0);
+
+    var = file.get_variable("unpacked_range");
+    var.write(packed.data());
+    packing = var.get_cf_packing();
+    REQUIRE(packing.valid_min == Approx(-500.0));
+    REQUIRE(packing.valid_max == Approx(500.0));
+    REQUIRE(packing.fill_value == NC_FILL_SHORT);
+
+    // Absent bounds are disabled by flags, not by infinite sentinels.
+    auto bound_tx = file.define();
+    bound_tx.add_variable("lower_bound", {"dimension_1", "dimension_2"}, netcdf4::Type::Short);
+    bound_tx.add_variable_attribute("lower_bound", "valid_min", static_cast<short>(0));
+    bound_tx.commit();
+    var = file.get_variable("lower_bound");
+    var.write(packed.data());
+    packing = var.get_cf_packing();
+    REQUIRE(packing.has_valid_min);
+    REQUIRE(!packing.has_valid_max);
+    REQUIRE(!packing.has_missing_value);
+    std::vector<double> bounded(200);
+    var.read_cf(bounded.data());
+    for (size_t i = 0; i < bounded.size(); ++i) {
+        if (packed[i] < 0) {
+            REQUIRE(is_nan_bits(bounded[i]));
+        } else {
+            REQUIRE(bounded[i] == static_cast<double>(packed[i]));
+        }
+    }
+
+    // Variables without packing attributes are passed through.
+    std::vector<double> values(200);
+    auto int_var = file.get_variable("int_variable_fixed");
+    std::vector<int> ints(200, 3);
+    int_var.write(ints.data());
+    int_var.read_cf(values.data());
+    REQUIRE(values == std::vector<double>(200, 3.0));
+}
+
+TEST_CASE( "test_attributes", "[netcdf]" ) {
+
+    std::string name = "test_attributes.nc";
+    auto file = create_test_file(name);
+
+    file.set_attribute("title", "attribute test");
+    file.set_attribute("version", 3);
+    file.set_attribute("keywords", std::vector<std::string>{"a", "b"});
+    auto var = file.get_variable("float_variable");
+    var.set_attribute("units", std::string("K"));
+    var.set_attribute("weight", -1.0f);
+    var.set_attribute("valid_range", std::vector<double>{0.0, 400.0});
+    var.set_attribute(netcdf4::Attribute("flags", std::vector<unsigned char>{1, 2, 4}));
+
+    // Data access after defining attributes.
+    var.write(std::array<size_t, 3>{0, 0, 0}, std::array<size_t, 3>{1, 1, 1}, std::vector<float>{1.0f}.data());
+
+    REQUIRE(var.has_attribute("units"));
+    REQUIRE(!var.has_attribute("long_name"));
+    REQUIRE(var.get_attribute("units").get_text() == "K");
+    REQUIRE_THROWS(var.get_attribute("long_name"));
+    file.close();
+
+    file = open_test_file(name);
+    REQUIRE(file.get_attribute("title").get_text() == "attribute test");
+    REQUIRE(file.get_attribute("version").get_type() == netcdf4::Type::Int);
+    REQUIRE(file.get_attribute("version").get_value<double>() == 3.0);
+    REQUIRE(file.get_attribute("keywords").get_strings() == std::vector<std::string>{"a", "b"});
+    REQUIRE(file.get_attribute_names() == std::vector<std::string>{"keywords", "title", "version"});
+
+    var = file.get_variable("float_variable");
+    REQUIRE(var.get_attribute_names().size() == 4);
+    REQUIRE(var.get_attribute("weight").get_value<float>() == -1.0f);
+    REQUIRE(var.get_attribute("valid_range").get_values<float>() == std::vector<float>{0.0f, 400.0f});
+    REQUIRE(var.get_attribute("flags").get_values<int>() == std::vector<int>{1, 2, 4});
+    REQUIRE_THROWS(var.get_attribute("units").get_values<int>());
+
+    // Copies share the attribute cache; CF packing follows attribute changes.
+    REQUIRE(var.get_cf_packing().valid_max == 400.0);
+    auto copy = file.get_variable("float_variable");
+    copy.set_attribute("valid_range", std::vector<float>{0.0f, 300.0f});
+    REQUIRE(var.get_attribute("valid_range").get_values<double>()[1] == 300.0);
+    REQUIRE(var.get_cf_packing().valid_max == 300.0);
+
+    // Attributes added through transactions to existing objects.
+    auto tx = file.define();
+    tx.add_attribute("history", "created");
+    tx.add_variable_attribute("float_variable", "long_name", "temperature");
+    tx.commit();
+    REQUIRE(file.get_attribute("history").get_text() == "created");
+    REQUIRE(var.get_attribute("long_name").get_text() == "temperature");
+}
+
+TEST_CASE( "test_read_only_mode", "[netcdf]" ) {
+
+    std::string name = "test_read_only_mode.nc";
+    auto file = create_test_file(name);
+    auto var = file.get_variable("int_variable_fixed");
+    std::vector<int> data(200, 7);
+    var.write(data.data());
+    file.close();
+
+    file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+    var = file.get_variable("int_variable_fixed");
+    std::vector<int> data_read(200);
+    var.read(data_read.data());
+    REQUIRE(data_read == data);
+    REQUIRE(var.read<int>() == 7);
+    file.sync();
+
+    REQUIRE_THROWS(var.write(data.data()));
+    REQUIRE_THROWS(var.write(1));
+    REQUIRE_THROWS(var.write_as(std::vector<double>(200).data()));
+    REQUIRE_THROWS(var.set_attribute("units", "m"));
+    REQUIRE_THROWS(file.add_dimension("dimension_3", 3));
+    REQUIRE_THROWS(file.add_variable("new_variable", {}, netcdf4::Type::Int));
+    REQUIRE_THROWS(file.add_group("new_group"));
+    auto tx = file.define();
+    tx.add_dimension("dimension_3", 3);
+    REQUIRE_THROWS(tx.commit());
+}
+
+TEST_CASE( "test_io_instrumentation", "[netcdf]" ) {
+
+    using netcdf4::CallCategory;
+    std::string name = "test_io_instrumentation.nc";
+    auto file = create_test_file(name);
+    auto var = file.get_variable("int_variable_fixed");
+    file.reset_io_stats();
+
+    std::vector<int> data(200, 3);
+    var.write(data.data());
+    var.read(data.data());
+    var.read(std::array<size_t, 2>{0, 0}, std::array<size_t, 2>{5, 10}, data.data());
+    var.read<int>();
+    file.sync();
+
+    auto stats = file.get_io_stats();
+    auto var_stats = var.get_io_stats();
+    if constexpr (netcdf4::instrumentation_enabled) {
+        REQUIRE(stats[CallCategory::Write].calls == 1);
+        REQUIRE(stats[CallCategory::Write].bytes == 200 * sizeof(int));
+        REQUIRE(stats[CallCategory::Read].calls == 3);
+        REQUIRE(stats[CallCategory::Read].bytes == (200 + 50 + 1) * sizeof(int));
+        REQUIRE(stats[CallCategory::Sync].calls == 1);
+        REQUIRE(var_stats[CallCategory::Read].calls == 3);
+        REQUIRE(var_stats[CallCategory::Sync].calls == 0);
+
+        size_t n_latencies = 0;
+        for (auto count : stats[CallCategory::Read].latency.bins) {
+            n_latencies += count;
+        }
+        REQUIRE(n_latencies == 3);
+        REQUIRE(stats.total().calls >= 5);
+
+        auto tx = file.define();
+        tx.add_dimension("dimension_3", 3);
+        tx.commit();
+        REQUIRE(file.get_io_stats()[CallCategory::ModeSwitch].calls == 2);
+
+        var.reset_io_stats();
+        REQUIRE(var.get_io_stats().total().calls == 0);
+        REQUIRE(file.get_io_stats()[CallCategory::Read].calls == 3);
+        file.reset_io_stats();
+        REQUIRE(file.get_io_stats().total().calls == 0);
+
+        // Storage and attribute definitions are counted as define calls,
+        // chunk planning and attribute parsing as inquiries.
+        auto storage_tx = file.define();
+        netcdf4::StorageOptions compressed{};
+        compressed.layout = netcdf4::Layout::Chunked;
+        compressed.deflate_level = 2;
+        storage_tx.add_variable("instrumented",
+                                {"dimension_1", "dimension_2"},
+                                netcdf4::Type::Float,
+                                compressed);
+        storage_tx.add_variable_attribute("instrumented", "units", "K");
+        storage_tx.commit();
+        auto instrumented = file.get_variable("instrumented");
+        // nc_def_var, nc_def_var_chunking, nc_def_var_deflate, nc_put_att
+        REQUIRE(file.get_io_stats()[CallCategory::Define].calls == 4);
+        REQUIRE(instrumented.get_io_stats()[CallCategory::Define].calls == 3);
+        REQUIRE(instrumented.get_io_stats()[CallCategory::Inquire].calls > 0);
+
+        instrumented.reset_io_stats();
+        REQUIRE(instrumented.get_attribute("units").get_text() == "K");
+        // nc_inq_varnatts, nc_inq_attname, nc_inq_att, nc_inq_type, nc_get_att
+        REQUIRE(instrumented.get_io_stats()[CallCategory::Inquire].calls == 5);
+        file.reset_io_stats();
+        file.set_attribute("instrumented", 1);
+        REQUIRE(file.get_io_stats()[CallCategory::Define].calls == 1);
+        REQUIRE(file.get_io_stats()[CallCategory::Inquire].calls > 0);
+    } else {
+        REQUIRE(stats.total().calls == 0);
+        REQUIRE(var_stats.total().calls == 0);
+    }
+}
+
+TEST_CASE( "test_trace_export", "[netcdf]" ) {
+
+    std::string name = "test_trace_export.nc";
+    create_test_file(name).close();
+
+    auto& recorder = netcdf4::TraceRecorder::get();
+    recorder.start();
+    auto file = netcdf4::File::open(name);
+    auto var = file.get_variable("int_variable_fixed");
+    std::vector<int> data(200, 1);
+    var.write(data.data());
+    var.read(std::array<size_t, 2>{1, 2}, std::array<size_t, 2>{3, 4}, data.data());
+    file.sync();
+    recorder.stop();
+    var.read(data.data());
+    file.close();
+
+    auto events = recorder.get_events();
+    std::stringstream trace;
+    recorder.write_chrome_trace(trace);
+    REQUIRE(trace.str().find("\"traceEvents\"") != std::string::npos);
+
+    if constexpr (netcdf4::instrumentation_enabled) {
+        std::vector<std::string> names;
+        for (auto& event : events) {
+            names.push_back(event.name);
+        }
+        REQUIRE(std::count(names.begin(), names.end(), "File::open") == 1);
+        REQUIRE(std::count(names.begin(), names.end(), "Group::parse_variables") == 0);
+        REQUIRE(std::count(names.begin(), names.end(), "Variable::write") == 1);
+        REQUIRE(std::count(names.begin(), names.end(), "Variable::read") == 1);
+        REQUIRE(std::count(names.begin(), names.end(), "Group::sync") == 1);
+
+        auto read = std::find_if(events.begin(), events.end(), [](auto& e) {
+            return e.name == "Variable::read";
+        });
+        REQUIRE(read->args == "{\"variable\": \"int_variable_fixed\", "
+                              "\"starts\": [1, 2], \"counts\": [3, 4], "
+                              "\"bytes\": 48}");
+        REQUIRE(trace.str().find("\"ph\": \"X\"") != std::string::npos);
+    } else {
+        REQUIRE(events.empty());
+    }
+}
+
+TEST_CASE( "test_record_appender", "[netcdf]" ) {
+
+    std::string name = "test_record_appender.nc";
+    auto file = create_test_file(name);
+    netcdf4::StorageOptions storage{};
+    storage.layout = netcdf4::Layout::Chunked;
+    storage.chunk_sizes = {4, 10, 20};
+    file.add_variable("chunked_variable",
+                      {"dimension_unlimited", "dimension_1", "dimension_2"},
+                      netcdf4::Type::Float,
+                      storage);
+    REQUIRE_THROWS(netcdf4::RecordAppender<int>(file.get_variable("int_variable_fixed")));
+
+    auto var = file.get_variable("chunked_variable");
+    auto n_records = [&]() {
+        size_t length = 0;
+        nc_inq_dimlen(file.get_id(), var.get_dimensions()[0].id, &length);
+        return length;
+    };
+    std::vector<float> records(11 * 200);
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i] = static_cast<float>(i);
+    }
+    {
+        netcdf4::RecordAppender<double> appender(var, 6);
+        REQUIRE(appender.get_capacity() == 8);
+        REQUIRE(appender.record_size() == 200);
+        std::vector<double> record(200);
+        for (size_t i = 0; i < 9; ++i) {
+            std::copy(records.begin() + 200 * i, records.begin() + 200 * (i + 1), record.begin());
+            appender.append(record.data());
+        }
+        // First block was written, the 9th record is buffered.
+        REQUIRE(appender.n_buffered() == 1);
+        REQUIRE(appender.size() == 9);
+        REQUIRE(n_records() == 8);
+        appender.flush();
+        REQUIRE(n_records() == 9);
+    }
+
+    // Appending continues after existing records.
+    netcdf4::RecordAppender<float> appender(var);
+    REQUIRE(appender.get_capacity() == 4);
+    REQUIRE(appender.size() == 9);
+    appender.append(records.data() + 9 * 200, 2);
+    REQUIRE(appender.n_buffered() == 2);
+    appender.flush();
+
+    std::vector<float> data(11 * 200);
+    var.read(data.data());
+    REQUIRE(data == records);
+
+    // Record shape follows the current lengths of the other dimensions.
+    file.add_dimension("dimension_unlimited_2");
+    auto ragged = file.add_variable("ragged",
+                                    {"dimension_unlimited", "dimension_unlimited_2"},
+                                    netcdf4::Type::Int);
+    REQUIRE_THROWS(netcdf4::RecordAppender<int>(ragged));
+    auto other = file.add_variable("other", {"dimension_unlimited_2"}, netcdf4::Type::Int);
+    std::vector<int> values = {1, 2, 3, 4, 5};
+    other.write(std::array<size_t, 1>{0}, std::array<size_t, 1>{5}, values.data());
+    netcdf4::RecordAppender<int> ragged_appender(ragged);
+    REQUIRE(ragged_appender.record_size() == 5);
+    ragged_appender.append(values.data());
+    REQUIRE(ragged_appender.n_buffered() == 1);
+}
+
+TEST_CASE( "test_chunk_policy", "[netcdf]" ) {
+
+    using netcdf4::AccessPattern;
+    std::vector<size_t> shape = {0, 1000, 1000};
+    std::vector<bool> unlimited = {true, false, false};
+    netcdf4::StorageOptions storage{};
+    size_t n_target = storage.chunk_bytes / sizeof(float);
+
+    auto plan = netcdf4::plan_chunks(shape, unlimited, sizeof(float), storage);
+    REQUIRE(plan.access_pattern == AccessPattern::Balanced);
+    REQUIRE(plan.chunk_bytes <= storage.chunk_bytes);
+    REQUIRE(plan.chunk_bytes > storage.chunk_bytes / 2);
+    REQUIRE(plan.chunk_sizes[0] > 1);
+
+    storage.access_pattern = AccessPattern::Records;
+    plan = netcdf4::plan_chunks(shape, unlimited, sizeof(float), storage);
+    REQUIRE(plan.chunk_sizes[0] == 1);
+    REQUIRE(plan.chunk_sizes[1] * plan.chunk_sizes[2] <= n_target);
+    REQUIRE(plan.chunk_sizes[1] * plan.chunk_sizes[2] > n_target / 2);
+
+    storage.access_pattern = AccessPattern::TimeSeries;
+    plan = netcdf4::plan_chunks(shape, unlimited, sizeof(float), storage);
+    REQUIRE(plan.chunk_sizes[0] >= 512);
+    REQUIRE(plan.chunk_bytes <= storage.chunk_bytes);
+    REQUIRE(!plan.description.empty());
+
+    // Fixed-size variables keep the library defaults unless asked otherwise.
+    storage.access_pattern = AccessPattern::Auto;
+    plan = netcdf4::plan_chunks({1000, 1000}, {false, false}, sizeof(float), storage);
+    REQUIRE(plan.access_pattern == AccessPattern::Library);
+    REQUIRE(plan.chunk_sizes.empty());
+
+    std::string name = "test_chunk_policy.nc";
+    auto file = create_test_file(name);
+    std::vector<std::string> dimensions = {"dimension_unlimited", "dimension_1", "dimension_2"};
+    storage.access_pattern = AccessPattern::TimeSeries;
+    storage.chunk_bytes = 1 << 16;
+    plan = file.plan_chunks(dimensions, netcdf4::Type::Float, storage);
+    REQUIRE(plan.chunk_sizes == std::vector<size_t>{163, 10, 10});
+    auto var = file.add_variable("time_series", dimensions, netcdf4::Type::Float, storage);
+    REQUIRE(var.get_storage().chunk_sizes == plan.chunk_sizes);
+
+    storage.access_pattern = AccessPattern::Library;
+    var = file.add_variable("library", dimensions, netcdf4::Type::Float, storage);
+    REQUIRE(var.get_storage().chunk_sizes[0] == 1);
+    REQUIRE(file.get_variable("int_variable").get_storage().chunk_sizes[0] > 1);
+}
+
+TEST_CASE( "test_fill_mode", "[netcdf]" ) {
+
+    using netcdf4::FillMode;
+    std::string name = "test_fill_mode.nc";
+    auto file = netcdf4::File::create(name, netcdf4::CreationMode::Clobber, FillMode::NoFill);
+    file.add_dimension("x", 100);
+    auto no_fill = file.add_variable("no_fill", {"x"}, netcdf4::Type::Float);
+    netcdf4::StorageOptions fill{};
+    fill.fill_mode = FillMode::Fill;
+    auto filled = file.add_variable("fill", {"x"}, netcdf4::Type::Float, fill);
+    REQUIRE(no_fill.get_storage().fill_mode == FillMode::NoFill);
+    REQUIRE(filled.get_storage().fill_mode == FillMode::Fill);
+
+    REQUIRE(file.set_fill_mode(FillMode::Fill) == FillMode::NoFill);
+    auto default_fill = file.add_variable("default", {"x"}, netcdf4::Type::Int);
+    netcdf4::StorageOptions storage{};
+    storage.fill_mode = FillMode::NoFill;
+    auto var_no_fill = file.add_variable("var_no_fill", {"x"}, netcdf4::Type::Int, storage);
+    REQUIRE(default_fill.get_storage().fill_mode == FillMode::Fill);
+    REQUIRE(var_no_fill.get_storage().fill_mode == FillMode::NoFill);
+
+    std::vector<float> data(100, 2.0f);
+    no_fill.write(data.data());
+    file.close();
+
+    file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+    std::vector<float> data_read(100);
+    file.get_variable("no_fill").read(data_read.data());
+    REQUIRE(data_read == data);
+    file.get_variable("fill").read(data_read.data());
+    REQUIRE(data_read[0] == NC_FILL_FLOAT);
+    REQUIRE_THROWS(file.set_fill_mode(FillMode::NoFill));
+}
+
+TEST_CASE( "test_in_memory_file", "[netcdf]" ) {
+
+    auto fill_file = [](netcdf4::File& file) {
+        auto tx = file.define();
+        tx.add_dimension("x", 100);
+        tx.add_variable("data", {"x"}, netcdf4::Type::Int);
+        tx.add_attribute("title", "in-memory product");
+        tx.commit();
+        std::vector<int> data(100);
+        std::iota(data.begin(), data.end(), 0);
+        file.get_variable("data").write(data.data());
+        return data;
+    };
+
+    std::string name = "test_in_memory.nc";
+    std::remove(name.c_str());
+    auto file = netcdf4::File::create_in_memory(name);
+    auto data = fill_file(file);
+    auto buffer = file.close_to_memory();
+    REQUIRE(buffer.size() > 0);
+    REQUIRE(std::string(buffer.begin() + 1, buffer.begin() + 4) == "HDF");
+    REQUIRE(!std::ifstream(name).good());
+    REQUIRE_THROWS(file.close_to_memory());
+
+    // Write buffer to disk and read it back.
+    {
+        std::ofstream out(name, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    }
+    file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+    std::vector<int> data_read(100);
+    file.get_variable("data").read(data_read.data());
+    REQUIRE(data_read == data);
+    REQUIRE(file.get_attribute("title").get_text() == "in-memory product");
+    REQUIRE_THROWS(file.close_to_memory());
+    file.close();
+
+    // Persisted in-memory files are written on close.
+    std::string persist_name = "test_in_memory_persist.nc";
+    file = netcdf4::File::create_in_memory(persist_name, true);
+    fill_file(file);
+    REQUIRE_THROWS(file.close_to_memory());
+    file.close();
+    file = netcdf4::File::open(persist_name, netcdf4::OpenMode::ReadOnly);
+    file.get_variable("data").read(data_read.data());
+    REQUIRE(data_read == data);
+}
+
+TEST_CASE( "test_open_memory", "[netcdf]" ) {
+
+    std::string name = "test_open_memory.nc";
+    auto file = create_test_file(name);
+    std::vector<int> data(200);
+    std::iota(data.begin(), data.end(), 0);
+    file.get_variable("int_variable_fixed").write(data.data());
+    file.close();
+
+    std::vector<std::byte> bytes;
+    {
+        std::ifstream in(name, std::ios::binary);
+        std::vector<char> chars((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        bytes.resize(chars.size());
+        std::memcpy(bytes.data(), chars.data(), chars.size());
+    }
+
+    auto check = [&](netcdf4::File file) {
+        std::vector<int> data_read(200);
+        file.get_variable("int_variable_fixed").read(data_read.data());
+        REQUIRE(data_read == data);
+        REQUIRE(file.has_variable("float_variable"));
+        REQUIRE_THROWS(file.get_variable("int_variable_fixed").write(data.data()));
+    };
+
+    // Copied data may be released after opening.
+    auto copy = bytes;
+    auto file_copy = netcdf4::File::open_memory(copy);
+    std::fill(copy.begin(), copy.end(), std::byte{0});
+    check(file_copy);
+
+    check(netcdf4::File::open_memory(bytes, netcdf4::BufferMode::ZeroCopy));
+
+    auto in_memory = netcdf4::File::create_in_memory();
+    in_memory.add_dimension("x", 3);
+    in_memory.add_variable("x", {"x"}, netcdf4::Type::Int).write(std::vector<int>{1, 2, 3}.data());
+    auto from_buffer = netcdf4::File::open_memory(in_memory.close_to_memory());
+    REQUIRE(from_buffer.get_variable("x").read<int>() == 1);
+
+    auto mapping = netcdf4::MappedFile::map(name);
+    REQUIRE(mapping->bytes().size() == bytes.size());
+    auto mapped_1 = netcdf4::File::open_memory(mapping);
+    auto mapped_2 = netcdf4::File::open_memory(mapping);
+    mapping.reset();
+    check(mapped_1);
+    check(mapped_2);
+    check(netcdf4::File::open_mapped(name, netcdf4::ParseMode::Eager));
+    REQUIRE_THROWS(netcdf4::File::open_mapped("does_not_exist.nc"));
+}
+
+TEST_CASE( "test_variable_map", "[netcdf]" ) {
+
+    std::string name = "test_variable_map.nc";
+    auto default_alignment = netcdf4::File::get_default_alignment();
+    netcdf4::File::set_default_alignment(0, 64);
+    REQUIRE(netcdf4::File::get_default_alignment() == std::pair<size_t, size_t>{0, 64});
+    auto file = create_test_file(name);
+    netcdf4::File::set_default_alignment(default_alignment.first,
+                                         default_alignment.second);
+
+    netcdf4::StorageOptions contiguous{};
+    contiguous.layout = netcdf4::Layout::Contiguous;
+    auto contiguous_var = file.add_variable(
+        "contiguous", {"dimension_1", "dimension_2"}, netcdf4::Type::Double, contiguous);
+    netcdf4::StorageOptions compressed{};
+    compressed.deflate_level = 1;
+    auto compressed_var = file.add_variable(
+        "compressed", {"dimension_1", "dimension_2"}, netcdf4::Type::Double, compressed);
+
+    std::vector<double> data(10 * 20);
+    std::iota(data.begin(), data.end(), 0.0);
+    contiguous_var.write(data.data());
+    compressed_var.write(data.data());
+
+    auto check = [&data](const netcdf4::VariableView<double>& view) {
+        REQUIRE(view.shape() == std::vector<size_t>{10, 20});
+        REQUIRE(view.size() == data.size());
+        REQUIRE(std::vector<double>(view.begin(), view.end()) == data);
+    };
+
+    auto view = contiguous_var.map<double>();
+    check(view);
+#ifdef NETCDFHPP_WITH_HDF5
+    REQUIRE(view.is_mapped());
+    // The mapping is shared until the file is modified.
+    REQUIRE(contiguous_var.map<double>().data() == view.data());
+    std::vector<double> modified(data.size(), -1.0);
+    compressed_var.write(modified.data());
+    auto remapped = contiguous_var.map<double>();
+    REQUIRE(remapped.data() != view.data());
+    check(remapped);
+    compressed_var.write(data.data());
+
+    // Fitting the chunk cache to a read does not invalidate the mapping.
+    auto before_read = contiguous_var.map<double>();
+    compressed_var.set_chunk_cache({1024, 7, 0.75});
+    compressed_var.set_chunk_cache_policy(netcdf4::ChunkCachePolicy::Auto);
+    std::vector<double> hyperslab(5 * 10);
+    compressed_var.read(std::array<size_t, 2>{2, 5}, std::array<size_t, 2>{5, 10},
+                        hyperslab.data());
+    REQUIRE(hyperslab[0] == data[2 * 20 + 5]);
+    REQUIRE(compressed_var.get_chunk_cache().size > 1024);
+    REQUIRE(contiguous_var.map<double>().data() == before_read.data());
+#endif
+    REQUIRE(!compressed_var.map<double>().is_mapped());
+    check(compressed_var.map<double>());
+    REQUIRE_THROWS(contiguous_var.map<int>());
+    file.close();
+
+    // The view stays valid after the file is closed.
+    check(view);
+
+    file = open_test_file(name);
+    auto reopened = file.get_variable("contiguous").map<double>();
+    check(reopened);
+#ifdef NETCDFHPP_WITH_HDF5
+    REQUIRE(reopened.is_mapped());
+#endif
+    check(file.get_variable("compressed").map<double>());
+}
+
+TEST_CASE( "test_strided_views", "[netcdf]" ) {
+
+    std::string name = "test_strided_views.nc";
+    auto file = create_test_file(name);
+    auto var = file.get_variable("int_variable_fixed");
+
+    netcdf4::NDArray<int, 2> data({10, 20});
+    std::iota(data.begin(), data.end(), 0);
+    var.write(data.view());
+    REQUIRE(var.read_array<int, 2>().vector() == data.vector());
+
+    // Read into a slice of a larger array.
+    netcdf4::NDArray<int, 2> larger({12, 24}, -1);
+    var.read(std::array<size_t, 2>{2, 5},
+             larger.view().slice({1, 2}, {8, 15}));
+    for (size_t i = 0; i < 12; ++i) {
+        for (size_t j = 0; j < 24; ++j) {
+            bool inside = (1 <= i) && (i < 9) && (2 <= j) && (j < 17);
+            int expected = inside ? data(i + 1, j + 3) : -1;
+            REQUIRE(larger(i, j) == expected);
+        }
+    }
+
+    // Read and write in column-major order.
+    std::vector<int> transposed(200);
+    netcdf4::StridedView<int, 2> column_major(transposed.data(), {10, 20}, {1, 10});
+    REQUIRE(!column_major.is_contiguous());
+    var.read(column_major);
+    REQUIRE(transposed[1] == data(1, 0));
+    REQUIRE(transposed[10] == data(0, 1));
+    for (auto& value : transposed) {
+        value = -value;
+    }
+    var.write(netcdf4::StridedView<const int, 2>(column_major));
+    auto negated = var.read_array<int, 2>({3, 4}, {2, 2});
+    REQUIRE(negated.shape() == std::array<size_t, 2>{2, 2});
+    REQUIRE(negated(1, 1) == -data(4, 5));
+
+    // Rank and extents are checked.
+    netcdf4::NDArray<int, 1> vector({200});
+    REQUIRE_THROWS(var.read(vector.view()));
+    REQUIRE_THROWS(var.read_array<int, 3>());
+    netcdf4::NDArray<int, 2> small({5, 5});
+    REQUIRE_THROWS(var.read(small.view()));
+    REQUIRE_THROWS(larger.view().slice({0, 0}, {13, 1}));
+    netcdf4::NDArray<float, 2> floats({10, 20});
+    REQUIRE_THROWS(var.read(floats.view()));
+
+    // Single values are still written as before.
+    auto single = file.get_variable("int_single_value");
+    single.write(42);
+    REQUIRE(single.read<int>() == 42);
+}
+
+TEST_CASE( "test_async_file", "[netcdf]" ) {
+
+    std::string name = "test_async_file.nc";
+    create_test_file(name).close();
+
+    auto file = netcdf4::AsyncFile::open(name);
+
+    // Write rows of the variable from multiple threads.
+    std::vector<std::thread> threads;
+    std::vector<std::future<void>> writes(10);
+    for (size_t i = 0; i < 10; ++i) {
+        threads.emplace_back([&file, &writes, i] {
+            std::vector<int> row(20);
+            std::iota(row.begin(), row.end(), static_cast<int>(20 * i));
+            writes[i] = file.write("int_variable_fixed",
+                                   std::array<size_t, 2>{i, 0},
+                                   std::array<size_t, 2>{1, 20},
+                                   std::move(row));
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& write : writes) {
+        write.get();
+    }
+
+    // Read into new buffer and into provided buffer.
+    auto data = file.read<int>("int_variable_fixed",
+                               std::array<size_t, 2>{0, 0},
+                               std::array<size_t, 2>{10, 20}).get();
+    std::vector<int> expected(200);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(data == expected);
+
+    std::vector<int> row(20);
+    auto read = file.read("int_variable_fixed",
+                          std::array<size_t, 2>{3, 0},
+                          std::array<size_t, 2>{1, 20},
+                          row.data());
+    read.get();
+    REQUIRE(row[0] == 60);
+
+    // Arbitrary calls and errors are passed through the futures.
+    auto n_dims = file.submit([](netcdf4::File& file) {
+        return file.get_variable("int_variable_fixed").shape().size();
+    });
+    REQUIRE(n_dims.get() == 2);
+    auto missing = file.read<int>("missing",
+                                  std::array<size_t, 1>{0},
+                                  std::array<size_t, 1>{1});
+    REQUIRE_THROWS(missing.get());
+    REQUIRE_THROWS(file.write("int_variable_fixed",
+                              std::array<size_t, 2>{0, 0},
+                              std::array<size_t, 2>{1, 20},
+                              std::vector<int>(19)));
+
+    file.sync().get();
+    file.close().get();
+    REQUIRE_THROWS(file.read<int>("int_variable_fixed",
+                                  std::array<size_t, 2>{0, 0},
+                                  std::array<size_t, 2>{1, 1}).get());
+
+    auto reopened = netcdf4::File::open(name);
+    std::vector<int> result(200);
+    reopened.get_variable("int_variable_fixed").read(result.data());
+    REQUIRE(result == expected);
+}
+
+TEST_CASE( "test_write_queue", "[netcdf]" ) {
+
+    std::string name = "test_write_queue.nc";
+    auto file = create_test_file(name);
+    auto var = file.get_variable("int_variable");
+
+    size_t n_steps = 5;
+    {
+        // Budget of two rows forces producers to wait for the writer.
+        netcdf4::WriteQueue<int, 3> queue(var, 2 * 20 * sizeof(int), 4);
+        REQUIRE(queue.get_capacity() == 4);
+        for (size_t step = 0; step < n_steps; ++step) {
+            std::vector<std::thread> producers;
+            for (size_t i = 0; i < 10; ++i) {
+                producers.emplace_back([&queue, step, i] {
+                    std::vector<int> row(20);
+                    std::iota(row.begin(), row.end(), static_cast<int>(1000 * step + 20 * i));
+                    queue.push({step, i, 0}, {1, 1, 20}, std::move(row));
+                });
+            }
+            for (auto& producer : producers) {
+                producer.join();
+            }
+            queue.flush();
+            REQUIRE(queue.get_buffered_bytes() == 0);
+        }
+
+        REQUIRE_THROWS(queue.push({0, 0, 0}, {1, 1, 20}, std::vector<int>(10)));
+        queue.push({0, 20, 0}, {1, 1, 20}, std::vector<int>(20));
+        REQUIRE_THROWS(queue.flush());
+        queue.flush();
+    }
+
+    // Errors after the last flush are reported by close.
+    {
+        netcdf4::WriteQueue<int, 3> queue(var);
+        queue.push({0, 20, 0}, {1, 1, 20}, std::vector<int>(20));
+        REQUIRE_THROWS(queue.close());
+        REQUIRE_THROWS(queue.push({0, 0, 0}, {1, 1, 20}, std::vector<int>(20)));
+        queue.close();
+    }
+
+    std::vector<int> data(n_steps * 10 * 20);
+    var.read(std::array<size_t, 3>{0, 0, 0},
+             std::array<size_t, 3>{n_steps, 10, 20},
+             data.data());
+    for (size_t step = 0; step < n_steps; ++step) {
+        for (size_t i = 0; i < 200; ++i) {
+            REQUIRE(data[200 * step + i] == static_cast<int>(1000 * step + i));
+        }
+    }
+
+    REQUIRE_THROWS(netcdf4::WriteQueue<float, 3>(var));
+    REQUIRE_THROWS(netcdf4::WriteQueue<int, 2>(var));
+}
+
+// Coroutine that starts eagerly and destroys itself when done.
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+DetachedTask read_row_async(netcdf4::Variable variable,
+                            size_t row,
+                            std::vector<int>& result,
+                            std::latch& done) {
+    std::vector<int> data(20);
+    co_await variable.read_async(std::array<size_t, 2>{row, 0},
+                                 std::array<size_t, 2>{1, 20},
+                                 data.data());
+    result = co_await variable.read_async<int>(std::array<size_t, 2>{row, 0},
+                                               std::array<size_t, 2>{1, 20});
+    if (result != data) {
+        result.clear();
+    }
+    done.count_down();
+}
+
+DetachedTask open_write_close_async(std::string name,
+                                    std::vector<int>& data,
+                                    std::string& error,
+                                    std::latch& done) {
+    try {
+        co_await netcdf4::File::open_async("does_not_exist.nc");
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    auto file = co_await netcdf4::File::open_async(name);
+    auto variable = file.get_variable("int_variable_fixed");
+    co_await variable.write_async(std::array<size_t, 2>{0, 0},
+                                  std::array<size_t, 2>{10, 20},
+                                  data.data());
+    co_await file.close_async();
+    done.count_down();
+}
+
+// Awaits a read and then blocks on other asynchronous I/O, which must not
+// deadlock since the coroutine isn't resumed on the I/O thread.
+DetachedTask read_then_block(netcdf4::Variable variable,
+                             netcdf4::AsyncFile& async_file,
+                             std::vector<int>& result,
+                             std::latch& done) {
+    result = co_await variable.read_async<int>(std::array<size_t, 2>{0, 0},
+                                               std::array<size_t, 2>{1, 20});
+    netcdf4::RecordReader<int> reader(variable, 2);
+    for (auto record : reader) {
+        result.insert(result.end(), record.begin(), record.end());
+    }
+    auto row = async_file.read<int>("int_variable_fixed",
+                                    std::array<size_t, 2>{9, 0},
+                                    std::array<size_t, 2>{1, 20}).get();
+    result.insert(result.end(), row.begin(), row.end());
+    done.count_down();
+}
+
+TEST_CASE( "test_coroutines", "[netcdf]" ) {
+
+    std::string name = "test_coroutines.nc";
+    create_test_file(name).close();
+
+    // The continuation executor is small by default and configurable.
+    REQUIRE(netcdf4::detail::IOExecutor::continuation_threads() >= 1);
+    REQUIRE(netcdf4::detail::IOExecutor::continuation_threads() <= 4);
+    netcdf4::set_continuation_threads(2);
+    REQUIRE(netcdf4::detail::IOExecutor::continuation_threads() == 2);
+
+    std::vector<int> data(200);
+    std::iota(data.begin(), data.end(), 0);
+    std::string error;
+    {
+        std::latch done(1);
+        open_write_close_async(name, data, error, done);
+        done.wait();
+    }
+    REQUIRE(error.find("does_not_exist.nc") != std::string::npos);
+
+    // Many concurrent reads from a single file.
+    auto file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+    auto variable = file.get_variable("int_variable_fixed");
+    size_t n_requests = 1000;
+    std::vector<std::vector<int>> results(n_requests);
+    std::latch done(n_requests);
+    for (size_t i = 0; i < n_requests; ++i) {
+        read_row_async(variable, i % 10, results[i], done);
+    }
+    done.wait();
+    for (size_t i = 0; i < n_requests; ++i) {
+        REQUIRE(results[i].size() == 20);
+        REQUIRE(results[i][0] == static_cast<int>(20 * (i % 10)));
+    }
+
+    // Blocking on record reads and async file requests after resumption.
+    {
+        auto async_file = netcdf4::AsyncFile::open(name, netcdf4::OpenMode::ReadOnly);
+        std::vector<int> result;
+        std::latch blocked(1);
+        read_then_block(variable, async_file, result, blocked);
+        blocked.wait();
+        REQUIRE(result.size() == 20 + 200 + 20);
+        REQUIRE(std::vector<int>(result.begin() + 20, result.begin() + 220) == data);
+        REQUIRE(result[220] == 180);
+    }
+}
+
+TEST_CASE( "test_record_reader", "[netcdf]" ) {
+
+    std::string name = "test_record_reader.nc";
+    auto file = create_test_file(name);
+    auto var = file.get_variable("int_variable");
+    size_t n_records = 7;
+    std::vector<int> data(n_records * 10 * 20);
+    std::iota(data.begin(), data.end(), 0);
+    var.write(std::array<size_t, 3>{0, 0, 0},
+              std::array<size_t, 3>{n_records, 10, 20},
+              data.data());
+
+    for (size_t n_prefetch : {1, 3, 10}) {
+        netcdf4::RecordReader<int> reader(var, n_prefetch);
+        REQUIRE(reader.size() == n_records);
+        REQUIRE(reader.record_size() == 200);
+        REQUIRE(reader.record_shape() == std::vector<size_t>{1, 10, 20});
+        size_t index = 0;
+        for (auto record : reader) {
+            REQUIRE(record.size() == 200);
+            REQUIRE(std::vector<int>(record.begin(), record.end()) ==
+                    std::vector<int>(data.begin() + 200 * index,
+                                     data.begin() + 200 * (index + 1)));
+            ++index;
+        }
+        REQUIRE(index == n_records);
+        REQUIRE(reader.next().empty());
+    }
+
+    // Iterate along the second dimension with conversion to double.
+    netcdf4::RecordReader<double> reader(var, 2, 1);
+    REQUIRE(reader.size() == 10);
+    REQUIRE(reader.record_shape() == std::vector<size_t>{n_records, 1, 20});
+    auto record = reader.next();
+    REQUIRE(record.size() == n_records * 20);
+    REQUIRE(record[20] == 200.0);
+    record = reader.next();
+    REQUIRE(record[0] == 20.0);
+    REQUIRE(reader.position() == 2);
+
+    // Abandoning the reader with pending reads is safe.
+    {
+        netcdf4::RecordReader<int> abandoned(var, 4);
+    }
+
+    REQUIRE_THROWS(netcdf4::RecordReader<int>(var, 2, 3));
+
+    // Readers and futures used on the I/O thread itself don't deadlock.
+    file.close();
+    auto async_file = netcdf4::AsyncFile::open(name, netcdf4::OpenMode::ReadOnly);
+    auto sum = async_file.submit([&async_file](netcdf4::File& file) {
+        netcdf4::RecordReader<int> reader(file.get_variable("int_variable"), 2);
+        long sum = 0;
+        for (auto record : reader) {
+            sum = std::accumulate(record.begin(), record.end(), sum);
+        }
+        auto first = async_file.read<int>("int_variable",
+                                          std::array<size_t, 3>{0, 0, 0},
+                                          std::array<size_t, 3>{1, 1, 1});
+        return sum + first.get()[0];
+    });
+    REQUIRE(sum.get() == std::accumulate(data.begin(), data.end(), 0L));
+}
+
+TEST_CASE( "test_read_parallel", "[netcdf]" ) {
+
+    std::string name = "test_read_parallel.nc";
+    auto file = netcdf4::File::create(name);
+    file.add_dimension("time");
+    file.add_dimension("x", 37);
+    file.add_dimension("y", 23);
+
+    // Chunks don't divide the extents, so that edge chunks are partial.
+    netcdf4::StorageOptions compressed{};
+    compressed.chunk_sizes = {2, 8, 10};
+    compressed.deflate_level = 3;
+    compressed.shuffle = true;
+    auto var = file.add_variable("compressed", {"time", "x", "y"}, netcdf4::Type::Double, compressed);
+    netcdf4::StorageOptions deflate_only = compressed;
+    deflate_only.shuffle = false;
+    auto var_deflate = file.add_variable("deflate", {"x", "y"}, netcdf4::Type::Short, deflate_only);
+    netcdf4::StorageOptions contiguous{};
+    contiguous.layout = netcdf4::Layout::Contiguous;
+    auto var_contiguous = file.add_variable("contiguous", {"x", "y"}, netcdf4::Type::Short, contiguous);
+
+    std::vector<double> data(5 * 37 * 23);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = std::sin(0.01 * static_cast<double>(i));
+    }
+    var.write(std::array<size_t, 3>{0, 0, 0}, std::array<size_t, 3>{5, 37, 23}, data.data());
+    std::vector<short> shorts(37 * 23);
+    std::iota(shorts.begin(), shorts.end(), -100);
+    var_deflate.write(shorts.data());
+    var_contiguous.write(shorts.data());
+
+    for (size_t n_threads : {0, 1, 3}) {
+        std::vector<double> result(data.size());
+        bool parallel = var.read_parallel(result.data(), n_threads);
+        REQUIRE(result == data);
+        std::vector<short> short_result(shorts.size());
+        bool parallel_deflate = var_deflate.read_parallel(short_result.data(), n_threads);
+        REQUIRE(short_result == shorts);
+#ifdef NETCDFHPP_WITH_HDF5
+        REQUIRE(parallel);
+        REQUIRE(parallel_deflate);
+#else
+        REQUIRE(!parallel);
+        REQUIRE(!parallel_deflate);
+#endif
+    }
+
+#ifdef NETCDFHPP_WITH_HDF5
+    // The chunk index is kept until the file is modified.
+    if constexpr (netcdf4::instrumentation_enabled) {
+        std::vector<double> result(data.size());
+        var.write(std::array<size_t, 3>{0, 0, 0}, std::array<size_t, 3>{5, 37, 23}, data.data());
+        var.reset_io_stats();
+        REQUIRE(var.read_parallel(result.data()));
+        size_t n_indexing = var.get_io_stats()[netcdf4::CallCategory::Inquire].calls;
+        var.reset_io_stats();
+        REQUIRE(var.read_parallel(result.data()));
+        size_t n_cached = var.get_io_stats()[netcdf4::CallCategory::Inquire].calls;
+        REQUIRE(n_cached < n_indexing);
+        REQUIRE(result == data);
+    }
+#endif
+
+    // Unsupported storage falls back to a regular read.
+    std::vector<short> short_result(shorts.size());
+    REQUIRE(!var_contiguous.read_parallel(short_result.data()));
+    REQUIRE(short_result == shorts);
+    std::vector<float> wrong_type(shorts.size());
+    REQUIRE_THROWS(var_deflate.read_parallel(wrong_type.data()));
+    file.close();
+
+    file = netcdf4::File::open(name, netcdf4::OpenMode::ReadOnly);
+    std::vector<double> result(data.size());
+    file.get_variable("compressed").read_parallel(result.data(), 2);
+    REQUIRE(result == data);
+}